@@ -0,0 +1,371 @@
+// Headless micro-benchmark for the watchface and its widgets.
+//
+// Runs the real face (src/c/watchface.c, whose main() is renamed to
+// watchface_main() for this build) against the host runtime, from its first
+// frame through its deferred startup phase, and sweeps every minute of an
+// hour (after the animation frames of a digit slide and a ring sweep), every
+// battery percent, settings sent from the phone, a tap-triggered burst of
+// second ticks and, on the charger, every second of an hour. Then it starts
+// the face again, which shows the frame it persisted on exit, and benchmarks
+// a standalone border widget. Each rendered frame is broken down per layer
+// update proc: invocations, draw calls, pixels written and wall time.
+// Finally it checks that a transition over too slow a draw skips frames, and
+// exits non-zero if not.
+//
+// usage: bench_<platform> [output-dir]
+//   writes <output-dir>/<platform>.csv (one row per proc per frame, with a
+//   hash of the resulting framebuffer) and
+//   <output-dir>/<platform>.txt (per-proc totals for each sweep).
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "host.h"
+#include "../src/c/modules/big_digit.h"
+#include "../src/c/modules/border.h"
+#include "../src/c/modules/calendar.h"
+#include "../src/c/modules/glyph_text.h"
+#include "../src/c/modules/invert.h"
+#include "../src/c/modules/power.h"
+#include "../src/c/modules/radial.h"
+#include "../src/c/modules/settings.h"
+#include "../src/c/modules/snapshot.h"
+#include "../src/c/modules/transition.h"
+#include "../src/c/modules/widget_alloc.h"
+
+int watchface_main(void);
+
+// 2026-03-31 11:59:00 UTC: the first tick rolls the hour, and the calendar
+// strip shows a month boundary.
+#define BENCH_START_TIME ((time_t)1774958340)
+
+typedef struct {
+    const char *scenario;
+    const char *sweep;
+    HostProcStats totals[HOST_MAX_PROCS];
+    int frames;
+} Sweep;
+
+static FILE *s_csv;
+static FILE *s_summary;
+static Sweep s_sweep;
+
+static void sweep_begin(const char *scenario, const char *sweep) {
+    memset(&s_sweep, 0, sizeof(s_sweep));
+    s_sweep.scenario = scenario;
+    s_sweep.sweep = sweep;
+    for (int i = 0; i < HOST_MAX_PROCS; i++) {
+        s_sweep.totals[i].min_ns = UINT64_MAX;
+    }
+}
+
+static const char *proc_name(const HostProcStats *stats, char *buffer, size_t size) {
+    if (stats->name) return stats->name;
+    snprintf(buffer, size, "proc@%p", (void *)stats->proc);
+    return buffer;
+}
+
+// Renders one frame and charges its cost to the current sweep.
+static void sweep_render(int step) {
+    host_stats_reset();
+    if (!host_render()) return;
+    s_sweep.frames++;
+    uint32_t frame_hash = host_framebuffer_hash();
+
+    for (int i = 0; i < host_stats_count(); i++) {
+        const HostProcStats *stats = host_stats_get(i);
+        if (!stats->calls) continue;
+        char name[32];
+        fprintf(s_csv, "%s,%s,%d,%s,%u,%u,%llu,%llu,%08x\n", s_sweep.scenario, s_sweep.sweep, step,
+                proc_name(stats, name, sizeof(name)), stats->calls, stats->draw_calls,
+                (unsigned long long)stats->pixels, (unsigned long long)stats->total_ns, (unsigned)frame_hash);
+
+        HostProcStats *total = &s_sweep.totals[i];
+        total->calls += stats->calls;
+        total->draw_calls += stats->draw_calls;
+        total->pixels += stats->pixels;
+        total->total_ns += stats->total_ns;
+        if (stats->min_ns < total->min_ns) total->min_ns = stats->min_ns;
+        if (stats->max_ns > total->max_ns) total->max_ns = stats->max_ns;
+    }
+}
+
+// The settled frame: transitions the step started are run to their end.
+static void sweep_frame(int step) {
+    host_finish_animations();
+    sweep_render(step);
+}
+
+static void sweep_end(void) {
+    fprintf(s_summary, "\n%s / %s: %d frames\n", s_sweep.scenario, s_sweep.sweep, s_sweep.frames);
+    fprintf(s_summary, "  %-24s %6s %10s %10s %9s %9s %9s\n", "proc", "calls", "draws/call", "px/call",
+            "avg_us", "min_us", "max_us");
+    for (int i = 0; i < host_stats_count(); i++) {
+        const HostProcStats *total = &s_sweep.totals[i];
+        if (!total->calls) continue;
+        char name[32];
+        fprintf(s_summary, "  %-24s %6u %10.1f %10.1f %9.2f %9.2f %9.2f\n",
+                proc_name(host_stats_get(i), name, sizeof(name)), total->calls,
+                (double)total->draw_calls / total->calls, (double)total->pixels / total->calls,
+                total->total_ns / 1000.0 / total->calls, total->min_ns / 1000.0, total->max_ns / 1000.0);
+    }
+}
+
+static void sweep_minutes(const char *scenario) {
+    sweep_begin(scenario, "minute");
+    for (int minute = 0; minute < MINUTES_PER_HOUR; minute++) {
+        host_advance_time(SECONDS_PER_MINUTE);
+        sweep_frame(minute);
+    }
+    sweep_end();
+}
+
+static void sweep_seconds(const char *scenario) {
+    sweep_begin(scenario, "second");
+    for (int second = 0; second < SECONDS_PER_HOUR; second++) {
+        host_advance_time(1);
+        sweep_frame(second);
+    }
+    sweep_end();
+}
+
+// A tap, then seconds until well after the burst it starts has ended.
+static void sweep_burst(const char *scenario) {
+    sweep_begin(scenario, "burst");
+    host_tap();
+    for (int second = 0; second < POWER_BURST_MS / 1000 + 30; second++) {
+        host_advance_time(1);
+        sweep_frame(second);
+    }
+    sweep_end();
+}
+
+static void sweep_battery(const char *scenario) {
+    sweep_begin(scenario, "battery");
+    for (int percent = 0; percent <= 100; percent++) {
+        host_set_battery((BatteryChargeState){.charge_percent = percent});
+        sweep_frame(percent);
+    }
+    sweep_end();
+}
+
+// face -----------------------------------------------------------------------
+
+static size_t s_heap_before_load;
+
+// The face starts in two phases: step 0 is its first frame, with only the
+// time, and step 1 the frame after the timer that builds the rest has run.
+static void sweep_load(const char *scenario) {
+    sweep_begin(scenario, "load");
+    sweep_frame(0);
+    host_advance_ms(1000);
+    sweep_frame(1);
+    sweep_end();
+}
+
+// Every animation frame of the next two minutes from the start time: the
+// hour rolls over, sliding the ones digit in and wrapping the ring, then the
+// ring sweeps on. Steps are milliseconds from the start time. The face is
+// then ticked back to the start time.
+static void sweep_transition(const char *scenario) {
+    sweep_begin(scenario, "transition");
+    for (int minute = 1; minute <= 2; minute++) {
+        host_advance_time(SECONDS_PER_MINUTE);
+        for (int ms = 0; ms <= 600; ms += HOST_ANIMATION_FRAME_MS) {
+            sweep_render(minute * 60000 + ms);
+            host_advance_ms(HOST_ANIMATION_FRAME_MS);
+        }
+        host_set_time(BENCH_START_TIME + minute * SECONDS_PER_MINUTE);
+    }
+    sweep_end();
+    host_set_time(BENCH_START_TIME - SECONDS_PER_MINUTE);
+    host_advance_time(SECONDS_PER_MINUTE);
+    host_finish_animations();
+}
+
+// One setting from the phone.
+static void send_setting(uint32_t key, uint8_t value) {
+    Tuple tuple = {.key = key, .type = TUPLE_UINT, .length = 1};
+    tuple.value->uint8 = value;
+    if (!host_app_message(&tuple, 1)) fprintf(stderr, "bench: app message %u not delivered\n", (unsigned)key);
+}
+
+// The light theme, the battery ring hidden and the saver profile, one message
+// each, then all back to the defaults in one.
+static void sweep_settings(const char *scenario) {
+    sweep_begin(scenario, "settings");
+    send_setting(MESSAGE_KEY_THEME, SETTINGS_THEME_LIGHT);
+    sweep_frame(0);
+    send_setting(MESSAGE_KEY_BATTERY, SETTINGS_BATTERY_HIDDEN);
+    sweep_frame(1);
+    // nothing to redraw until the next tick under the saver profile
+    send_setting(MESSAGE_KEY_POWER, SETTINGS_POWER_SAVER);
+    sweep_frame(2);
+
+    const Tuple defaults[] = {
+        {.key = MESSAGE_KEY_THEME, .type = TUPLE_UINT, .length = 1, .value = {{.uint8 = SETTINGS_THEME_DARK}}},
+        {.key = MESSAGE_KEY_BATTERY, .type = TUPLE_UINT, .length = 1, .value = {{.uint8 = SETTINGS_BATTERY_RING}}},
+        {.key = MESSAGE_KEY_POWER, .type = TUPLE_UINT, .length = 1, .value = {{.uint8 = SETTINGS_POWER_AUTO}}},
+    };
+    host_app_message(defaults, sizeof(defaults) / sizeof(defaults[0]));
+    sweep_frame(3);
+    sweep_end();
+}
+
+// The clock is put back after loading, so the sweeps start on the minute.
+static void face_event_loop(void) {
+    sweep_load("face");
+    host_set_time(BENCH_START_TIME);
+
+    fprintf(s_summary, "\nface heap: %zu B used by the loaded window, %zu B free\n",
+            heap_bytes_used() - s_heap_before_load, heap_bytes_free());
+#if defined(WIDGET_ARENA_SIZE)
+    fprintf(s_summary, "widget arena: %zu of %d B used\n", widget_arena_used(), WIDGET_ARENA_SIZE);
+#endif
+
+    sweep_transition("face");
+    sweep_minutes("face");
+    sweep_battery("face");
+    sweep_settings("face");
+    sweep_burst("face");
+
+    // on the charger the power governor moves the face to second ticks
+    host_set_battery((BatteryChargeState){.charge_percent = 100, .is_plugged = true});
+    sweep_seconds("face");
+}
+
+// Started again in the minute it exited in, the face's first frame is the
+// persisted snapshot of its last one.
+static void restart_event_loop(void) {
+    sweep_load("restart");
+}
+
+// border ---------------------------------------------------------------------
+
+static BorderWidget *s_border;
+
+// Incremental mode needs a window that doesn't repaint its background.
+static void bench_border(const char *scenario, bool incremental, TimeUnits unit) {
+    Window *window = window_create();
+    window_set_background_color(window, incremental ? GColorClear : GColorBlack);
+    window_stack_push(window, false);
+
+    Layer *root = window_get_root_layer(window);
+    s_border = widget_border_create(layer_get_bounds(root), 3);
+    widget_border_set_incremental(s_border, incremental);
+    layer_add_child(root, s_border->layer);
+    widget_scheduler_add(s_border, &BORDER_WIDGET_CLASS, unit, NULL);
+    widget_scheduler_subscribe();
+
+    host_set_time(BENCH_START_TIME);
+    if (unit == SECOND_UNIT) {
+        widget_border_set_resolution(s_border, SECONDS_PER_HOUR);
+        sweep_seconds(scenario);
+    } else {
+        sweep_minutes(scenario);
+    }
+
+    widget_scheduler_destroy_all();
+    window_destroy(window);
+}
+
+// transition budget ----------------------------------------------------------
+
+#define SLOW_DRAW_MS 30
+
+static int32_t s_slow_value;
+
+// Over TRANSITION_DRAW_BUDGET_MS, by the face's own (real time) clock.
+static void slow_update(Layer *layer, GContext *ctx) {
+    nanosleep(&(struct timespec){.tv_nsec = SLOW_DRAW_MS * 1000000L}, NULL);
+}
+
+static void slow_apply(void *widget, int32_t value) {
+    s_slow_value = value;
+    layer_mark_dirty(widget);
+}
+
+// A transition on a layer whose every draw overruns the budget must skip
+// frames. False if it didn't.
+static bool check_transition_budget(void) {
+    Window *window = window_create();
+    window_stack_push(window, false);
+    Layer *root = window_get_root_layer(window);
+    Layer *slow = layer_create(layer_get_bounds(root));
+    layer_set_update_proc(slow, slow_update);
+    layer_add_child(root, slow);
+
+    const uint32_t skipped = transition_skipped_frames();
+    transition_start(slow, slow, slow_apply, 0, 100, TRANSITION_MAX_FRAMES * TRANSITION_FRAME_MS);
+    while (transition_running(slow)) {
+        host_render();
+        host_advance_ms(HOST_ANIMATION_FRAME_MS);
+    }
+    const bool ok = transition_skipped_frames() > skipped && s_slow_value == 100;
+    fprintf(s_summary, "\ntransition budget: %u frames skipped with %d ms draws%s\n",
+            (unsigned)(transition_skipped_frames() - skipped), SLOW_DRAW_MS, ok ? "" : ", expected some");
+
+    layer_destroy(slow);
+    window_destroy(window);
+    return ok;
+}
+
+// main -----------------------------------------------------------------------
+
+static FILE *open_output(const char *dir, const char *ext) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.%s", dir, HOST_PLATFORM_NAME, ext);
+    FILE *f = fopen(path, "w");
+    if (!f) fprintf(stderr, "bench: cannot write %s: %s\n", path, strerror(errno));
+    return f;
+}
+
+int main(int argc, char **argv) {
+    const char *out_dir = argc > 1 ? argv[1] : ".";
+    mkdir(out_dir, 0755);
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    s_csv = open_output(out_dir, "csv");
+    s_summary = open_output(out_dir, "txt");
+    if (!s_csv || !s_summary) return 1;
+    fprintf(s_csv, "scenario,sweep,step,proc,calls,draw_calls,pixels,ns,frame\n");
+    fprintf(s_summary, "== %s %dx%d ==\n", HOST_PLATFORM_NAME, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+
+    host_register_proc(widget_border_update, "widget_border_update");
+    host_register_proc(widget_radial_update, "widget_radial_update");
+    host_register_proc(widget_big_digit_update, "widget_big_digit_update");
+    host_register_proc(widget_calendar_update, "widget_calendar_update");
+    host_register_proc(widget_glyph_text_update, "widget_glyph_text_update");
+    host_register_proc(widget_snapshot_update, "widget_snapshot_update");
+    host_register_proc(widget_snapshot_capture_update, "widget_snapshot_capture_update");
+    host_register_proc(invert_layer_update, "invert_layer_update");
+
+    host_set_time(BENCH_START_TIME);
+    host_set_battery((BatteryChargeState){.charge_percent = 100});
+    host_set_event_loop(face_event_loop);
+    s_heap_before_load = heap_bytes_used();
+    watchface_main();
+    host_set_event_loop(NULL);
+    if (heap_bytes_used() != s_heap_before_load) {
+        fprintf(s_summary, "\nface heap: %zu B not freed after exit\n", heap_bytes_used() - s_heap_before_load);
+    }
+#if defined(WIDGET_ARENA_SIZE)
+    fprintf(s_summary, "widget arena: %zu B used after exit, %zu B at most\n", widget_arena_used(),
+            widget_arena_peak());
+#endif
+
+    host_set_event_loop(restart_event_loop);
+    watchface_main();
+    host_set_event_loop(NULL);
+
+    bench_border("border", false, MINUTE_UNIT);
+    bench_border("border_incremental", true, MINUTE_UNIT);
+    bench_border("border_seconds", true, SECOND_UNIT);
+    const bool budget_ok = check_transition_budget();
+
+    fclose(s_csv);
+    fclose(s_summary);
+    if (!budget_ok) fprintf(stderr, "bench: slow draws skipped no transition frames\n");
+    return budget_ok ? 0 : 1;
+}
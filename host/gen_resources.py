@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""Generate the host build's resource headers from package.json.
+
+Mirrors what the Pebble SDK does at build time: every entry under
+pebble.resources.media becomes a RESOURCE_ID_<name> constant, numbered from 1
+in declaration order. The host runtime additionally gets a table mapping each
+id to its type and source file so it can load it from resources/. Each name
+in pebble.messageKeys becomes a MESSAGE_KEY_<name> constant.
+"""
+import json
+import os
+import sys
+
+
+def main(package_json, out_dir):
+    with open(package_json) as f:
+        pebble = json.load(f)['pebble']
+    media = pebble['resources']['media']
+    message_keys = pebble.get('messageKeys', [])
+
+    os.makedirs(out_dir, exist_ok=True)
+
+    with open(os.path.join(out_dir, 'resource_ids.auto.h'), 'w') as f:
+        f.write('#pragma once\n// generated by host/gen_resources.py from package.json\n\n')
+        f.write('typedef enum {\n    RESOURCE_ID_INVALID = 0,\n')
+        for entry in media:
+            f.write('    RESOURCE_ID_{},\n'.format(entry['name']))
+        f.write('} ResourceId;\n')
+
+    # numbered from 10000 in declaration order, like the SDK does
+    with open(os.path.join(out_dir, 'message_keys.auto.h'), 'w') as f:
+        f.write('#pragma once\n// generated by host/gen_resources.py from package.json\n\n')
+        for i, name in enumerate(message_keys):
+            f.write('#define MESSAGE_KEY_{} {}\n'.format(name, 10000 + i))
+
+    with open(os.path.join(out_dir, 'resource_table.auto.h'), 'w') as f:
+        f.write('// generated by host/gen_resources.py from package.json\n')
+        for entry in media:
+            f.write('HOST_RESOURCE("{}", "{}", "{}")\n'.format(
+                entry['type'], entry['name'], entry['file']))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1], sys.argv[2])
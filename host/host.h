@@ -0,0 +1,83 @@
+#pragma once
+// Control surface of the host runtime, used by the benchmark driver and never
+// by the watchface itself.
+#include <pebble.h>
+
+#if defined(PBL_PLATFORM_APLITE)
+#define HOST_PLATFORM_NAME "aplite"
+#elif defined(PBL_PLATFORM_BASALT)
+#define HOST_PLATFORM_NAME "basalt"
+#elif defined(PBL_PLATFORM_CHALK)
+#define HOST_PLATFORM_NAME "chalk"
+#elif defined(PBL_PLATFORM_DIORITE)
+#define HOST_PLATFORM_NAME "diorite"
+#elif defined(PBL_PLATFORM_EMERY)
+#define HOST_PLATFORM_NAME "emery"
+#endif
+
+#define HOST_MAX_PROCS 32
+#define HOST_MAX_TIMERS 8
+#define HOST_MAX_PERSIST 32
+#define HOST_MAX_ANIMATIONS 8
+#define HOST_ANIMATION_FRAME_MS 33
+
+// Cost of one layer update proc, accumulated over every invocation since the
+// last host_stats_reset().
+typedef struct {
+    const char *name;
+    LayerUpdateProc proc;
+    uint32_t calls;
+    uint32_t draw_calls;   // graphics_* primitives issued
+    uint64_t pixels;       // framebuffer pixels written
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+} HostProcStats;
+
+// Name an update proc in the stats tables; unnamed procs are listed by address.
+void host_register_proc(LayerUpdateProc proc, const char *name);
+
+void host_stats_reset(void);
+int host_stats_count(void);
+const HostProcStats *host_stats_get(int index);
+
+// Runs `loop` in place of the SDK event loop the next time the face calls
+// app_event_loop().
+void host_set_event_loop(void (*loop)(void));
+
+// Simulated wall clock read by time()/localtime().
+void host_set_time(time_t now);
+time_t host_get_time(void);
+
+// Advances the clock, firing the app timers that come due on the way, then
+// delivers a tick to the subscribed TickHandler with the units that actually
+// changed, like the firmware does.
+void host_advance_time(int seconds);
+void host_advance_ms(uint32_t ms);
+
+// Runs every scheduled animation to its end without moving the clock, so a
+// frame can be rendered in the state the animations settle in.
+void host_finish_animations(void);
+
+// Delivers a battery event to the subscribed BatteryStateHandler.
+void host_set_battery(BatteryChargeState state);
+
+// Delivers a tap to the subscribed AccelTapHandler.
+void host_tap(void);
+
+// Redraws the top window if any of its layers are dirty. Returns true if a
+// frame was rendered.
+bool host_render(void);
+
+// Forces a full redraw, as on window appear.
+void host_invalidate(void);
+
+GBitmap *host_framebuffer(void);
+
+// FNV-1a hash of the framebuffer, to compare rendering paths frame by frame.
+uint32_t host_framebuffer_hash(void);
+int host_vibe_count(void);
+
+// Delivers a message from the phone to the face's inbox handler. False when
+// AppMessage isn't open or the tuples don't fit its inbox.
+bool host_app_message(const Tuple *tuples, int count);
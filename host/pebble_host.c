@@ -0,0 +1,1600 @@
+// Host implementation of the Pebble SDK subset declared in pebble.h.
+//
+// Layers, windows and services behave like the firmware as far as the face
+// can observe: a dirty layer redraws the whole window tree, every update proc
+// starts from a fresh drawing state clipped to its layer, and the framebuffer
+// keeps its contents between frames. Drawing goes into a framebuffer with the
+// platform's real resolution and pixel format, and every primitive is charged
+// to the update proc that issued it.
+#define _XOPEN_SOURCE 700
+#include <math.h>
+#include <png.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#include "host.h"
+
+#ifndef HOST_RESOURCE_DIR
+#define HOST_RESOURCE_DIR "resources"
+#endif
+
+#undef time
+
+#if defined(PBL_BW)
+#define FB_FORMAT GBitmapFormat1Bit
+#elif defined(PBL_ROUND)
+#define FB_FORMAT GBitmapFormat8BitCircular
+#else
+#define FB_FORMAT GBitmapFormat8Bit
+#endif
+
+// memory ---------------------------------------------------------------------
+
+// App memory per platform. On the watch the app's code and static data come
+// out of the same budget, so heap_bytes_free() here is an upper bound.
+#if defined(PBL_PLATFORM_APLITE)
+#define HOST_HEAP_SIZE (24 * 1024)
+#elif defined(PBL_PLATFORM_EMERY)
+#define HOST_HEAP_SIZE (128 * 1024)
+#else
+#define HOST_HEAP_SIZE (64 * 1024)
+#endif
+
+// Each block carries its size in front of the payload.
+typedef union {
+    size_t size;
+    max_align_t align;
+} HeapHeader;
+
+static size_t s_heap_used;
+
+void *host_malloc(size_t size) {
+    if (size > HOST_HEAP_SIZE - s_heap_used) return NULL;
+    HeapHeader *block = (malloc)(sizeof(HeapHeader) + size);
+    if (!block) return NULL;
+    block->size = size;
+    s_heap_used += size;
+    return block + 1;
+}
+
+void *host_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void *ptr = host_malloc(count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void *host_realloc(void *ptr, size_t size) {
+    if (!ptr) return host_malloc(size);
+    HeapHeader *block = (HeapHeader *)ptr - 1;
+    if (size > block->size && size - block->size > HOST_HEAP_SIZE - s_heap_used) return NULL;
+    HeapHeader *grown = (realloc)(block, sizeof(HeapHeader) + size);
+    if (!grown) return NULL;
+    s_heap_used = s_heap_used - grown->size + size;
+    grown->size = size;
+    return grown + 1;
+}
+
+void host_free(void *ptr) {
+    if (!ptr) return;
+    HeapHeader *block = (HeapHeader *)ptr - 1;
+    s_heap_used -= block->size;
+    (free)(block);
+}
+
+size_t heap_bytes_used(void) {
+    return s_heap_used;
+}
+
+size_t heap_bytes_free(void) {
+    return HOST_HEAP_SIZE - s_heap_used;
+}
+
+// resources ------------------------------------------------------------------
+
+struct HostResource {
+    const char *type;
+    const char *name;
+    const char *file;
+};
+
+#define HOST_RESOURCE(type, name, file) {type, name, file},
+static const struct HostResource s_resources[] = {
+#include "resource_table.auto.h"
+};
+#undef HOST_RESOURCE
+
+#define RESOURCE_COUNT (sizeof(s_resources) / sizeof(s_resources[0]))
+
+// Like the SDK, a file tagged with the platform name ("name~emery.png") is
+// picked over the untagged one.
+static void resource_path(ResHandle h, char *path, size_t size) {
+    const char *ext = strrchr(h->file, '.');
+    int base = ext ? (int)(ext - h->file) : (int)strlen(h->file);
+    struct stat st;
+    snprintf(path, size, "%s/%.*s~%s%s", HOST_RESOURCE_DIR, base, h->file, HOST_PLATFORM_NAME, ext ? ext : "");
+    if (stat(path, &st) == 0) return;
+    snprintf(path, size, "%s/%s", HOST_RESOURCE_DIR, h->file);
+}
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+    if (resource_id == 0 || resource_id > RESOURCE_COUNT) return NULL;
+    return &s_resources[resource_id - 1];
+}
+
+size_t resource_size(ResHandle h) {
+    if (!h) return 0;
+    char path[256];
+    resource_path(h, path, sizeof(path));
+    struct stat st;
+    return stat(path, &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes) {
+    if (!h) return 0;
+    char path[256];
+    resource_path(h, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t read = 0;
+    if (fseek(f, start_offset, SEEK_SET) == 0) {
+        read = fread(buffer, 1, num_bytes, f);
+    }
+    fclose(f);
+    return read;
+}
+
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length) {
+    return resource_load_byte_range(h, 0, buffer, max_length);
+}
+
+// geometry and color ---------------------------------------------------------
+
+bool grect_equal(const GRect *const rect_a, const GRect *const rect_b) {
+    return rect_a->origin.x == rect_b->origin.x && rect_a->origin.y == rect_b->origin.y &&
+           rect_a->size.w == rect_b->size.w && rect_a->size.h == rect_b->size.h;
+}
+
+bool gpoint_equal(const GPoint *const point_a, const GPoint *const point_b) {
+    return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+    return x.argb == y.argb;
+}
+
+static GRect grect_intersect(GRect a, GRect b) {
+    int x0 = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+    int y0 = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+    int x1 = a.origin.x + a.size.w < b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w;
+    int y1 = a.origin.y + a.size.h < b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h;
+    if (x1 < x0) x1 = x0;
+    if (y1 < y0) y1 = y0;
+    return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+void grect_clip(GRect *const rect_to_clip, const GRect *const rect_clipper) {
+    *rect_to_clip = grect_intersect(*rect_to_clip, *rect_clipper);
+}
+
+// 1-bit displays show a color as white when it is at least as bright as
+// light gray, like the SDK's own fallbacks for GColorLightGray/GColorDarkGray.
+static bool gcolor_is_white(GColor8 color) {
+    return color.r + color.g + color.b >= 5;
+}
+
+int32_t sin_lookup(int32_t angle) {
+    return (int32_t)lround(sin(angle * 2.0 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle) {
+    return (int32_t)lround(cos(angle * 2.0 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t atan2_lookup(int16_t y, int16_t x) {
+    double a = atan2(y, x);
+    if (a < 0) a += 2 * M_PI;
+    return (int32_t)(a * TRIG_MAX_ANGLE / (2 * M_PI)) % TRIG_MAX_ANGLE;
+}
+
+// bitmaps --------------------------------------------------------------------
+
+struct GBitmap {
+    uint8_t *addr;
+    uint16_t row_size_bytes;
+    GBitmapFormat format;
+    GRect bounds;
+    bool owns_data;
+};
+
+static uint16_t row_size_for(GBitmapFormat format, int width) {
+    if (format == GBitmapFormat1Bit) {
+        return ((width + 31) / 32) * 4;
+    }
+    return width;
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+    if (format != GBitmapFormat1Bit && format != GBitmapFormat8Bit && format != GBitmapFormat8BitCircular) {
+        return NULL;
+    }
+    GBitmap *bitmap = calloc(1, sizeof(GBitmap));
+    if (!bitmap) return NULL;
+    bitmap->format = format;
+    bitmap->row_size_bytes = row_size_for(format, size.w);
+    bitmap->bounds = GRect(0, 0, size.w, size.h);
+    bitmap->addr = calloc(bitmap->row_size_bytes, size.h > 0 ? size.h : 1);
+    bitmap->owns_data = true;
+    if (!bitmap->addr) {
+        free(bitmap);
+        return NULL;
+    }
+    return bitmap;
+}
+
+GBitmap *gbitmap_create_as_sub_bitmap(const GBitmap *base_bitmap, GRect sub_rect) {
+    if (!base_bitmap) return NULL;
+    GBitmap *bitmap = malloc(sizeof(GBitmap));
+    if (!bitmap) return NULL;
+    *bitmap = *base_bitmap;
+    sub_rect.origin.x += base_bitmap->bounds.origin.x;
+    sub_rect.origin.y += base_bitmap->bounds.origin.y;
+    bitmap->bounds = grect_intersect(sub_rect, base_bitmap->bounds);
+    bitmap->owns_data = false;
+    return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+    if (!bitmap) return;
+    if (bitmap->owns_data) free(bitmap->addr);
+    free(bitmap);
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+    return bitmap ? bitmap->bounds : GRectZero;
+}
+
+void gbitmap_set_bounds(GBitmap *bitmap, GRect bounds) {
+    if (bitmap) bitmap->bounds = bounds;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+    return bitmap ? bitmap->addr : NULL;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+    return bitmap ? bitmap->row_size_bytes : 0;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+    return bitmap ? bitmap->format : GBitmapFormat1Bit;
+}
+
+#if defined(PBL_ROUND)
+static int16_t s_round_min_x[PBL_DISPLAY_HEIGHT];
+static int16_t s_round_max_x[PBL_DISPLAY_HEIGHT];
+
+static void round_mask_init(void) {
+    const double r = PBL_DISPLAY_WIDTH / 2.0;
+    for (int y = 0; y < PBL_DISPLAY_HEIGHT; y++) {
+        double dy = y + 0.5 - r;
+        double half = sqrt(r * r - dy * dy);
+        int min_x = (int)lround(r - half);
+        s_round_min_x[y] = min_x;
+        s_round_max_x[y] = PBL_DISPLAY_WIDTH - 1 - min_x;
+    }
+}
+#endif
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+    GBitmapDataRowInfo info = {
+        .data = bitmap->addr + y * bitmap->row_size_bytes,
+        .min_x = bitmap->bounds.origin.x,
+        .max_x = bitmap->bounds.origin.x + bitmap->bounds.size.w - 1,
+    };
+#if defined(PBL_ROUND)
+    if (bitmap->format == GBitmapFormat8BitCircular && y < PBL_DISPLAY_HEIGHT) {
+        info.min_x = s_round_min_x[y];
+        info.max_x = s_round_max_x[y];
+    }
+#endif
+    return info;
+}
+
+static GColor8 bitmap_get_pixel(const GBitmap *bitmap, int x, int y) {
+    const uint8_t *row = bitmap->addr + y * bitmap->row_size_bytes;
+    if (bitmap->format == GBitmapFormat1Bit) {
+        return ((row[x / 8] >> (x % 8)) & 1) ? GColorWhite : GColorBlack;
+    }
+    return (GColor8){.argb = row[x]};
+}
+
+static void bitmap_set_pixel(GBitmap *bitmap, int x, int y, GColor8 color) {
+    uint8_t *row = bitmap->addr + y * bitmap->row_size_bytes;
+    if (bitmap->format == GBitmapFormat1Bit) {
+        if (gcolor_is_white(color)) {
+            row[x / 8] |= 1 << (x % 8);
+        } else {
+            row[x / 8] &= ~(1 << (x % 8));
+        }
+    } else {
+        row[x] = color.argb | 0xC0;
+    }
+}
+
+GBitmap *gbitmap_create_with_resource(uint32_t resource_id) {
+    ResHandle h = resource_get_handle(resource_id);
+    if (!h) return NULL;
+    char path[256];
+    resource_path(h, path, sizeof(path));
+
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, path)) return NULL;
+    image.format = PNG_FORMAT_RGBA;
+    uint8_t *rgba = (malloc)(PNG_IMAGE_SIZE(image));
+    if (!rgba || !png_image_finish_read(&image, NULL, rgba, 0, NULL)) {
+        png_image_free(&image);
+        (free)(rgba);
+        return NULL;
+    }
+
+    // The SDK converts bitmaps to the platform's native format at build time.
+    GBitmap *bitmap = gbitmap_create_blank(GSize(image.width, image.height),
+                                           PBL_IF_BW_ELSE(GBitmapFormat1Bit, GBitmapFormat8Bit));
+    if (bitmap) {
+        for (uint32_t y = 0; y < image.height; y++) {
+            for (uint32_t x = 0; x < image.width; x++) {
+                const uint8_t *p = rgba + (y * image.width + x) * 4;
+                GColor8 color = {.argb = (uint8_t)(((p[3] >> 6) << 6) | ((p[0] >> 6) << 4) |
+                                                   ((p[1] >> 6) << 2) | (p[2] >> 6))};
+                if (bitmap->format == GBitmapFormat1Bit) {
+                    bitmap_set_pixel(bitmap, x, y, color.a ? color : GColorBlack);
+                } else {
+                    bitmap->addr[y * bitmap->row_size_bytes + x] = color.argb;
+                }
+            }
+        }
+    }
+    (free)(rgba);
+    return bitmap;
+}
+
+// fonts ----------------------------------------------------------------------
+
+struct HostFont {
+    char name[48];
+    int height;
+    bool custom;
+};
+
+#define MAX_SYSTEM_FONTS 16
+static struct HostFont s_system_fonts[MAX_SYSTEM_FONTS];
+static int s_system_font_count;
+
+// Fonts are sized by the number in their key or resource name, which is how
+// both the SDK (GOTHIC_14) and this project (FONT_RUBIK_18) name them.
+static int font_height_from_name(const char *name) {
+    int height = 0;
+    for (const char *p = name; *p; p++) {
+        if (*p >= '0' && *p <= '9') {
+            height = height * 10 + (*p - '0');
+        } else if (height) {
+            break;
+        }
+    }
+    return height ? height : 14;
+}
+
+GFont fonts_get_system_font(const char *font_key) {
+    for (int i = 0; i < s_system_font_count; i++) {
+        if (strcmp(s_system_fonts[i].name, font_key) == 0) return &s_system_fonts[i];
+    }
+    if (s_system_font_count == MAX_SYSTEM_FONTS) return &s_system_fonts[0];
+    struct HostFont *font = &s_system_fonts[s_system_font_count++];
+    snprintf(font->name, sizeof(font->name), "%s", font_key);
+    font->height = font_height_from_name(font_key);
+    return font;
+}
+
+GFont fonts_load_custom_font(ResHandle handle) {
+    if (!handle) return NULL;
+    struct HostFont *font = calloc(1, sizeof(struct HostFont));
+    if (!font) return NULL;
+    snprintf(font->name, sizeof(font->name), "%s", handle->name);
+    font->height = font_height_from_name(handle->name);
+    font->custom = true;
+    return font;
+}
+
+void fonts_unload_custom_font(GFont font) {
+    if (font && font->custom) free(font);
+}
+
+// stats ----------------------------------------------------------------------
+
+static HostProcStats s_stats[HOST_MAX_PROCS];
+static int s_stats_count;
+static HostProcStats *s_current;
+static uint64_t s_overhead_ns; // host bookkeeping inside the current proc, not charged to it
+
+static HostProcStats *stats_for(LayerUpdateProc proc) {
+    for (int i = 0; i < s_stats_count; i++) {
+        if (s_stats[i].proc == proc) return &s_stats[i];
+    }
+    if (s_stats_count == HOST_MAX_PROCS) return NULL;
+    HostProcStats *stats = &s_stats[s_stats_count++];
+    memset(stats, 0, sizeof(*stats));
+    stats->proc = proc;
+    stats->min_ns = UINT64_MAX;
+    return stats;
+}
+
+void host_register_proc(LayerUpdateProc proc, const char *name) {
+    HostProcStats *stats = stats_for(proc);
+    if (stats) stats->name = name;
+}
+
+void host_stats_reset(void) {
+    for (int i = 0; i < s_stats_count; i++) {
+        s_stats[i].calls = 0;
+        s_stats[i].draw_calls = 0;
+        s_stats[i].pixels = 0;
+        s_stats[i].total_ns = 0;
+        s_stats[i].min_ns = UINT64_MAX;
+        s_stats[i].max_ns = 0;
+    }
+}
+
+int host_stats_count(void) {
+    return s_stats_count;
+}
+
+const HostProcStats *host_stats_get(int index) {
+    return index >= 0 && index < s_stats_count ? &s_stats[index] : NULL;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// graphics -------------------------------------------------------------------
+
+struct GContext {
+    GBitmap *fb;
+    GPoint offset;  // screen position of the drawing layer's bounds origin
+    GRect clip;     // screen coordinates
+    GColor fill_color;
+    GColor stroke_color;
+    GColor text_color;
+    uint8_t stroke_width;
+    bool antialiased;
+    GCompOp compositing_mode;
+    bool fb_captured;
+    uint8_t *fb_snapshot;
+};
+
+static GBitmap *s_fb;
+static GContext s_ctx;
+
+static void context_reset(GContext *ctx, GPoint offset, GRect clip) {
+    ctx->offset = offset;
+    ctx->clip = clip;
+    ctx->fill_color = GColorBlack;
+    ctx->stroke_color = GColorBlack;
+    ctx->text_color = GColorWhite;
+    ctx->stroke_width = 1;
+    ctx->antialiased = true;
+    ctx->compositing_mode = GCompOpAssign;
+}
+
+static void count_draw(void) {
+    if (s_current) s_current->draw_calls++;
+}
+
+// Writes one pixel in screen coordinates, honoring the clip and, on round
+// displays, the visible circle.
+static inline void put_pixel(GContext *ctx, int x, int y, GColor8 color) {
+    if (x < ctx->clip.origin.x || x >= ctx->clip.origin.x + ctx->clip.size.w) return;
+    if (y < ctx->clip.origin.y || y >= ctx->clip.origin.y + ctx->clip.size.h) return;
+#if defined(PBL_ROUND)
+    if (x < s_round_min_x[y] || x > s_round_max_x[y]) return;
+#endif
+    bitmap_set_pixel(ctx->fb, x, y, color);
+    if (s_current) s_current->pixels++;
+}
+
+static void fill_span(GContext *ctx, int x0, int x1, int y, GColor8 color) {
+    for (int x = x0; x < x1; x++) {
+        put_pixel(ctx, x, y, color);
+    }
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+    ctx->fill_color = color;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+    ctx->stroke_color = color;
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {
+    ctx->text_color = color;
+}
+
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width) {
+    if (stroke_width > 0) ctx->stroke_width = stroke_width;
+}
+
+void graphics_context_set_antialiased(GContext *ctx, bool enable) {
+    ctx->antialiased = enable;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {
+    ctx->compositing_mode = mode;
+}
+
+static void stroke_point(GContext *ctx, int x, int y) {
+    int w = ctx->stroke_width;
+    int x0 = ctx->offset.x + x - (w - 1) / 2;
+    int y0 = ctx->offset.y + y - (w - 1) / 2;
+    for (int dy = 0; dy < w; dy++) {
+        fill_span(ctx, x0, x0 + w, y0 + dy, ctx->stroke_color);
+    }
+}
+
+void graphics_draw_pixel(GContext *ctx, GPoint point) {
+    count_draw();
+    if (!ctx->stroke_color.a) return;
+    put_pixel(ctx, ctx->offset.x + point.x, ctx->offset.y + point.y, ctx->stroke_color);
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+    count_draw();
+    if (!ctx->stroke_color.a) return;
+    int x0 = p0.x, y0 = p0.y, x1 = p1.x, y1 = p1.y;
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        stroke_point(ctx, x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void graphics_draw_rect(GContext *ctx, GRect rect) {
+    count_draw();
+    if (!ctx->stroke_color.a || rect.size.w <= 0 || rect.size.h <= 0) return;
+    int x0 = ctx->offset.x + rect.origin.x;
+    int y0 = ctx->offset.y + rect.origin.y;
+    int x1 = x0 + rect.size.w;
+    int y1 = y0 + rect.size.h;
+    fill_span(ctx, x0, x1, y0, ctx->stroke_color);
+    fill_span(ctx, x0, x1, y1 - 1, ctx->stroke_color);
+    for (int y = y0 + 1; y < y1 - 1; y++) {
+        put_pixel(ctx, x0, y, ctx->stroke_color);
+        put_pixel(ctx, x1 - 1, y, ctx->stroke_color);
+    }
+}
+
+// Horizontal inset of row `dy` (0 = outermost) of a rounded corner.
+static int corner_inset(int radius, int dy) {
+    if (dy >= radius) return 0;
+    double d = radius - dy - 0.5;
+    return radius - (int)lround(sqrt((double)radius * radius - d * d));
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+    count_draw();
+    if (!ctx->fill_color.a || rect.size.w <= 0 || rect.size.h <= 0) return;
+    int x0 = ctx->offset.x + rect.origin.x;
+    int y0 = ctx->offset.y + rect.origin.y;
+    int x1 = x0 + rect.size.w;
+    int h = rect.size.h;
+    int radius = corner_radius;
+    if (radius > rect.size.w / 2) radius = rect.size.w / 2;
+    if (radius > h / 2) radius = h / 2;
+
+    for (int row = 0; row < h; row++) {
+        int left = 0, right = 0;
+        if (radius && corner_mask) {
+            int top_inset = corner_inset(radius, row);
+            int bottom_inset = corner_inset(radius, h - 1 - row);
+            if (corner_mask & GCornerTopLeft) left = top_inset;
+            if (corner_mask & GCornerTopRight) right = top_inset;
+            if ((corner_mask & GCornerBottomLeft) && bottom_inset > left) left = bottom_inset;
+            if ((corner_mask & GCornerBottomRight) && bottom_inset > right) right = bottom_inset;
+        }
+        fill_span(ctx, x0 + left, x1 - right, y0 + row, ctx->fill_color);
+    }
+}
+
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness,
+                          int32_t angle_start, int32_t angle_end) {
+    count_draw();
+    if (!ctx->fill_color.a || angle_end <= angle_start) return;
+    int diameter = rect.size.w < rect.size.h ? rect.size.w : rect.size.h;
+    if (scale_mode == GOvalScaleModeFillCircle) {
+        diameter = rect.size.w > rect.size.h ? rect.size.w : rect.size.h;
+    }
+    const double cx = rect.origin.x + rect.size.w / 2.0;
+    const double cy = rect.origin.y + rect.size.h / 2.0;
+    const double outer = diameter / 2.0;
+    const double inner = outer - inset_thickness;
+    const bool full = angle_end - angle_start >= TRIG_MAX_ANGLE;
+    int32_t start = angle_start % TRIG_MAX_ANGLE;
+    if (start < 0) start += TRIG_MAX_ANGLE;
+    const int32_t end = start + (angle_end - angle_start);
+
+    for (int y = (int)floor(cy - outer); y < (int)ceil(cy + outer); y++) {
+        for (int x = (int)floor(cx - outer); x < (int)ceil(cx + outer); x++) {
+            double dx = x + 0.5 - cx;
+            double dy = y + 0.5 - cy;
+            double d = sqrt(dx * dx + dy * dy);
+            if (d >= outer || d < inner) continue;
+            if (!full) {
+                // TRIG angles start at 12 o'clock and grow clockwise.
+                double a = atan2(dx, -dy);
+                if (a < 0) a += 2 * M_PI;
+                int32_t angle = (int32_t)(a * TRIG_MAX_ANGLE / (2 * M_PI));
+                if (!((angle >= start && angle < end) ||
+                      (angle + TRIG_MAX_ANGLE >= start && angle + TRIG_MAX_ANGLE < end))) {
+                    continue;
+                }
+            }
+            put_pixel(ctx, ctx->offset.x + x, ctx->offset.y + y, ctx->fill_color);
+        }
+    }
+}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+    count_draw();
+    if (!bitmap || bitmap->bounds.size.w <= 0 || bitmap->bounds.size.h <= 0) return;
+    const GRect src = bitmap->bounds;
+    for (int y = 0; y < rect.size.h; y++) {
+        int sy = src.origin.y + y % src.size.h;
+        for (int x = 0; x < rect.size.w; x++) {
+            int sx = src.origin.x + x % src.size.w;
+            GColor8 color = bitmap_get_pixel(bitmap, sx, sy);
+            if (ctx->compositing_mode == GCompOpSet &&
+                (bitmap->format == GBitmapFormat1Bit ? !gcolor_is_white(color) : !color.a)) {
+                continue;
+            }
+            put_pixel(ctx, ctx->offset.x + rect.origin.x + x, ctx->offset.y + rect.origin.y + y, color);
+        }
+    }
+}
+
+// Text is approximated with one hollow box per glyph, sized from the font
+// height. That keeps the host free of a font rasterizer while still charging
+// text-heavy procs for roughly the pixels real glyphs would cover.
+static int text_advance(const GFont font) {
+    return font->height * 11 / 20 > 0 ? font->height * 11 / 20 : 1;
+}
+
+GSize graphics_text_layout_get_content_size(const char *text, const GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment) {
+    if (!text || !font) return GSize(0, 0);
+    int width = strlen(text) * text_advance(font);
+    return GSize(width < box.size.w ? width : box.size.w, font->height);
+}
+
+void graphics_draw_text(GContext *ctx, const char *text, const GFont font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes *text_attributes) {
+    count_draw();
+    if (!text || !font || !ctx->text_color.a) return;
+    const int h = font->height;
+    const int advance = text_advance(font);
+    const int stroke = h / 8 > 0 ? h / 8 : 1;
+    const int glyph_w = advance - stroke;
+    const int glyph_h = h * 7 / 10;
+    const int len = strlen(text);
+    const int width = len * advance;
+
+    int x = box.origin.x;
+    if (alignment == GTextAlignmentCenter) {
+        x += (box.size.w - width) / 2;
+    } else if (alignment == GTextAlignmentRight) {
+        x += box.size.w - width;
+    }
+    const int y = box.origin.y + h - glyph_h;
+
+    // Glyphs never spill outside the text box.
+    GRect saved_clip = ctx->clip;
+    ctx->clip = grect_intersect(ctx->clip, GRect(ctx->offset.x + box.origin.x, ctx->offset.y + box.origin.y,
+                                                 box.size.w, box.size.h));
+    for (int i = 0; i < len; i++, x += advance) {
+        if (text[i] == ' ') continue;
+        int gx = ctx->offset.x + x;
+        int gy = ctx->offset.y + y;
+        for (int row = 0; row < glyph_h; row++) {
+            if (row < stroke || row >= glyph_h - stroke) {
+                fill_span(ctx, gx, gx + glyph_w, gy + row, ctx->text_color);
+            } else {
+                fill_span(ctx, gx, gx + stroke, gy + row, ctx->text_color);
+                fill_span(ctx, gx + glyph_w - stroke, gx + glyph_w, gy + row, ctx->text_color);
+            }
+        }
+    }
+    ctx->clip = saved_clip;
+}
+
+// Pixels written straight into a captured framebuffer bypass put_pixel, so on
+// release they are charged as the number of pixels that changed. Taking the
+// snapshot and diffing it is left out of the proc's time.
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+    if (ctx->fb_captured) return NULL;
+    uint64_t start = now_ns();
+    size_t size = (size_t)ctx->fb->row_size_bytes * ctx->fb->bounds.size.h;
+    ctx->fb_snapshot = (malloc)(size);
+    if (ctx->fb_snapshot) memcpy(ctx->fb_snapshot, ctx->fb->addr, size);
+    ctx->fb_captured = true;
+    s_overhead_ns += now_ns() - start;
+    count_draw();
+    return ctx->fb;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+    if (!ctx->fb_captured || buffer != ctx->fb) return false;
+    uint64_t start = now_ns();
+    if (ctx->fb_snapshot && s_current) {
+        GBitmap before = *ctx->fb;
+        before.addr = ctx->fb_snapshot;
+        for (int y = 0; y < ctx->fb->bounds.size.h; y++) {
+            for (int x = 0; x < ctx->fb->bounds.size.w; x++) {
+                if (!gcolor_equal(bitmap_get_pixel(&before, x, y), bitmap_get_pixel(ctx->fb, x, y))) {
+                    s_current->pixels++;
+                }
+            }
+        }
+    }
+    (free)(ctx->fb_snapshot);
+    ctx->fb_snapshot = NULL;
+    ctx->fb_captured = false;
+    s_overhead_ns += now_ns() - start;
+    return true;
+}
+
+GBitmap *host_framebuffer(void) {
+    return s_fb;
+}
+
+uint32_t host_framebuffer_hash(void) {
+    uint32_t hash = 2166136261u;
+    size_t size = (size_t)s_fb->row_size_bytes * s_fb->bounds.size.h;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ s_fb->addr[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// layers ---------------------------------------------------------------------
+
+struct Window;
+
+struct Layer {
+    GRect frame;
+    GRect bounds;
+    LayerUpdateProc update_proc;
+    Layer *parent;
+    Layer *first_child;
+    Layer *next_sibling;
+    struct Window *window;  // set on a window's root layer only
+    bool hidden;
+    _Alignas(max_align_t) uint8_t data[];
+};
+
+static bool s_dirty;
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+    Layer *layer = calloc(1, sizeof(Layer) + data_size);
+    if (!layer) return NULL;
+    layer->frame = frame;
+    layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+    return layer;
+}
+
+Layer *layer_create(GRect frame) {
+    return layer_create_with_data(frame, 0);
+}
+
+void layer_remove_from_parent(Layer *child) {
+    if (!child || !child->parent) return;
+    Layer **link = &child->parent->first_child;
+    while (*link && *link != child) link = &(*link)->next_sibling;
+    if (*link) *link = child->next_sibling;
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    s_dirty = true;
+}
+
+void layer_destroy(Layer *layer) {
+    if (!layer) return;
+    layer_remove_from_parent(layer);
+    for (Layer *child = layer->first_child; child;) {
+        Layer *next = child->next_sibling;
+        child->parent = NULL;
+        child->next_sibling = NULL;
+        child = next;
+    }
+    free(layer);
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+    if (!parent || !child) return;
+    layer_remove_from_parent(child);
+    Layer **link = &parent->first_child;
+    while (*link) link = &(*link)->next_sibling;
+    *link = child;
+    child->parent = parent;
+    s_dirty = true;
+}
+
+void layer_insert_below_sibling(Layer *layer_to_insert, Layer *below_sibling_layer) {
+    if (!layer_to_insert || !below_sibling_layer || !below_sibling_layer->parent) return;
+    layer_remove_from_parent(layer_to_insert);
+    Layer **link = &below_sibling_layer->parent->first_child;
+    while (*link != below_sibling_layer) link = &(*link)->next_sibling;
+    layer_to_insert->next_sibling = below_sibling_layer;
+    *link = layer_to_insert;
+    layer_to_insert->parent = below_sibling_layer->parent;
+    s_dirty = true;
+}
+
+void layer_insert_above_sibling(Layer *layer_to_insert, Layer *above_sibling_layer) {
+    if (!layer_to_insert || !above_sibling_layer || !above_sibling_layer->parent) return;
+    layer_remove_from_parent(layer_to_insert);
+    layer_to_insert->next_sibling = above_sibling_layer->next_sibling;
+    above_sibling_layer->next_sibling = layer_to_insert;
+    layer_to_insert->parent = above_sibling_layer->parent;
+    s_dirty = true;
+}
+
+void layer_mark_dirty(Layer *layer) {
+    if (layer) s_dirty = true;
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+    if (layer) layer->update_proc = update_proc;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+    if (!layer) return;
+    layer->frame = frame;
+    layer->bounds.size = frame.size;
+    s_dirty = true;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+    return layer ? layer->frame : GRectZero;
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds) {
+    if (!layer) return;
+    layer->bounds = bounds;
+    s_dirty = true;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+    return layer ? layer->bounds : GRectZero;
+}
+
+void *layer_get_data(const Layer *layer) {
+    return layer ? (void *)layer->data : NULL;
+}
+
+GPoint layer_convert_point_to_screen(const Layer *layer, GPoint point) {
+    for (; layer; layer = layer->parent) {
+        point.x += layer->frame.origin.x + layer->bounds.origin.x;
+        point.y += layer->frame.origin.y + layer->bounds.origin.y;
+    }
+    return point;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+    if (layer && layer->hidden != hidden) {
+        layer->hidden = hidden;
+        s_dirty = true;
+    }
+}
+
+bool layer_get_hidden(const Layer *layer) {
+    return layer ? layer->hidden : false;
+}
+
+static void render_layer(Layer *layer, GPoint parent_origin, GRect parent_clip) {
+    if (layer->hidden) return;
+    GPoint origin = GPoint(parent_origin.x + layer->frame.origin.x, parent_origin.y + layer->frame.origin.y);
+    GRect clip = grect_intersect(parent_clip, GRect(origin.x, origin.y, layer->frame.size.w, layer->frame.size.h));
+    GPoint offset = GPoint(origin.x + layer->bounds.origin.x, origin.y + layer->bounds.origin.y);
+
+    if (layer->update_proc) {
+        context_reset(&s_ctx, offset, clip);
+        HostProcStats *stats = stats_for(layer->update_proc);
+        s_current = stats;
+        s_overhead_ns = 0;
+        uint64_t start = now_ns();
+        layer->update_proc(layer, &s_ctx);
+        uint64_t elapsed = now_ns() - start - s_overhead_ns;
+        s_current = NULL;
+        if (stats) {
+            stats->calls++;
+            stats->total_ns += elapsed;
+            if (elapsed < stats->min_ns) stats->min_ns = elapsed;
+            if (elapsed > stats->max_ns) stats->max_ns = elapsed;
+        }
+    }
+    for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+        render_layer(child, offset, clip);
+    }
+}
+
+// text layers ----------------------------------------------------------------
+
+struct TextLayer {
+    Layer *layer;
+    const char *text;
+    GFont font;
+    GColor text_color;
+    GColor background_color;
+    GTextAlignment alignment;
+    GTextOverflowMode overflow_mode;
+};
+
+static void text_layer_update(Layer *layer, GContext *ctx) {
+    TextLayer *text_layer = *(TextLayer **)layer_get_data(layer);
+    GRect bounds = layer_get_bounds(layer);
+    if (text_layer->background_color.a) {
+        graphics_context_set_fill_color(ctx, text_layer->background_color);
+        graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+    }
+    if (text_layer->text && text_layer->text[0]) {
+        graphics_context_set_text_color(ctx, text_layer->text_color);
+        graphics_draw_text(ctx, text_layer->text, text_layer->font, bounds, text_layer->overflow_mode,
+                           text_layer->alignment, NULL);
+    }
+}
+
+TextLayer *text_layer_create(GRect frame) {
+    TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+    if (!text_layer) return NULL;
+    text_layer->layer = layer_create_with_data(frame, sizeof(TextLayer *));
+    if (!text_layer->layer) {
+        free(text_layer);
+        return NULL;
+    }
+    *(TextLayer **)layer_get_data(text_layer->layer) = text_layer;
+    layer_set_update_proc(text_layer->layer, text_layer_update);
+    text_layer->font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+    text_layer->text_color = GColorBlack;
+    text_layer->background_color = GColorWhite;
+    text_layer->alignment = GTextAlignmentLeft;
+    text_layer->overflow_mode = GTextOverflowModeWordWrap;
+    host_register_proc(text_layer_update, "text_layer");
+    return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+    if (!text_layer) return;
+    layer_destroy(text_layer->layer);
+    free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+    return text_layer ? text_layer->layer : NULL;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+    if (!text_layer) return;
+    text_layer->text = text;
+    layer_mark_dirty(text_layer->layer);
+}
+
+const char *text_layer_get_text(TextLayer *text_layer) {
+    return text_layer ? text_layer->text : NULL;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+    if (!text_layer) return;
+    text_layer->background_color = color;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+    if (!text_layer) return;
+    text_layer->text_color = color;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+    if (!text_layer) return;
+    text_layer->font = font;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+    if (!text_layer) return;
+    text_layer->alignment = text_alignment;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode) {
+    if (!text_layer) return;
+    text_layer->overflow_mode = line_mode;
+    layer_mark_dirty(text_layer->layer);
+}
+
+// windows --------------------------------------------------------------------
+
+struct Window {
+    Layer *root;
+    WindowHandlers handlers;
+    GColor background_color;
+    bool loaded;
+};
+
+static Window *s_top_window;
+
+static void window_root_update(Layer *layer, GContext *ctx) {
+    Window *window = *(Window **)layer_get_data(layer);
+    if (window->background_color.a) {
+        graphics_context_set_fill_color(ctx, window->background_color);
+        graphics_fill_rect(ctx, layer_get_bounds(layer), 0, GCornerNone);
+    }
+}
+
+static void host_init_display(void) {
+    if (s_fb) return;
+#if defined(PBL_ROUND)
+    round_mask_init();
+#endif
+    // The framebuffer is the system's, not part of the app heap.
+    static GBitmap s_fb_bitmap;
+    s_fb_bitmap = (GBitmap){
+        .row_size_bytes = row_size_for(FB_FORMAT, PBL_DISPLAY_WIDTH),
+        .format = FB_FORMAT,
+        .bounds = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT),
+    };
+    s_fb_bitmap.addr = (calloc)(s_fb_bitmap.row_size_bytes, PBL_DISPLAY_HEIGHT);
+    s_fb = &s_fb_bitmap;
+    s_ctx.fb = s_fb;
+    host_register_proc(window_root_update, "window");
+}
+
+Window *window_create(void) {
+    host_init_display();
+    Window *window = calloc(1, sizeof(Window));
+    if (!window) return NULL;
+    window->root = layer_create_with_data(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT), sizeof(Window *));
+    *(Window **)layer_get_data(window->root) = window;
+    window->root->window = window;
+    layer_set_update_proc(window->root, window_root_update);
+    window->background_color = GColorWhite;
+    return window;
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+    if (window) window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+    if (!window) return;
+    window->background_color = background_color;
+    s_dirty = true;
+}
+
+Layer *window_get_root_layer(const Window *window) {
+    return window ? window->root : NULL;
+}
+
+void window_stack_push(Window *window, bool animated) {
+    if (!window || window == s_top_window) return;
+    if (s_top_window) window_stack_pop(false);
+    s_top_window = window;
+    if (!window->loaded) {
+        window->loaded = true;
+        if (window->handlers.load) window->handlers.load(window);
+    }
+    if (window->handlers.appear) window->handlers.appear(window);
+    s_dirty = true;
+}
+
+Window *window_stack_pop(bool animated) {
+    Window *window = s_top_window;
+    if (!window) return NULL;
+    if (window->handlers.disappear) window->handlers.disappear(window);
+    if (window->loaded) {
+        window->loaded = false;
+        if (window->handlers.unload) window->handlers.unload(window);
+    }
+    s_top_window = NULL;
+    return window;
+}
+
+void window_destroy(Window *window) {
+    if (!window) return;
+    if (window == s_top_window) window_stack_pop(false);
+    layer_destroy(window->root);
+    free(window);
+}
+
+bool host_render(void) {
+    if (!s_top_window || !s_dirty) return false;
+    s_dirty = false;
+    GRect screen = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+    render_layer(s_top_window->root, GPointZero, screen);
+    return true;
+}
+
+void host_invalidate(void) {
+    s_dirty = true;
+}
+
+// time -----------------------------------------------------------------------
+
+static time_t s_now;
+static uint16_t s_now_ms; // milliseconds into the current second, for app timers
+
+time_t host_time(time_t *tloc) {
+    if (tloc) *tloc = s_now;
+    return s_now;
+}
+
+// time_ms reads the host's real clock, so the face's own timing code measures
+// real durations even though time() is simulated.
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint16_t ms = ts.tv_nsec / 1000000;
+    if (tloc) *tloc = ts.tv_sec;
+    if (out_ms) *out_ms = ms;
+    return ms;
+}
+
+void host_set_time(time_t now) {
+    s_now = now;
+    s_now_ms = 0;
+}
+
+time_t host_get_time(void) {
+    return s_now;
+}
+
+static int64_t clock_ms(void) {
+    return (int64_t)s_now * 1000 + s_now_ms;
+}
+
+static void clock_set_ms(int64_t ms) {
+    s_now = ms / 1000;
+    s_now_ms = ms % 1000;
+}
+
+// app timers -----------------------------------------------------------------
+
+struct AppTimer {
+    bool active;
+    int64_t due_ms;
+    AppTimerCallback callback;
+    void *data;
+};
+
+static AppTimer s_timers[HOST_MAX_TIMERS];
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+    for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+        if (!s_timers[i].active) {
+            s_timers[i] = (AppTimer){true, clock_ms() + timeout_ms, callback, callback_data};
+            return &s_timers[i];
+        }
+    }
+    return NULL;
+}
+
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms) {
+    if (!timer || !timer->active) return false;
+    timer->due_ms = clock_ms() + new_timeout_ms;
+    return true;
+}
+
+void app_timer_cancel(AppTimer *timer) {
+    if (timer) timer->active = false;
+}
+
+// Fires the timers due by `until_ms` in due order, with the clock set to each
+// one's due time so that timers registered from a callback count from there.
+static void timers_run(int64_t until_ms) {
+    for (;;) {
+        AppTimer *next = NULL;
+        for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+            AppTimer *timer = &s_timers[i];
+            if (timer->active && timer->due_ms <= until_ms && (!next || timer->due_ms < next->due_ms)) {
+                next = timer;
+            }
+        }
+        if (!next) return;
+        if (next->due_ms > clock_ms()) clock_set_ms(next->due_ms);
+        next->active = false;
+        next->callback(next->data);
+    }
+}
+
+// animations -----------------------------------------------------------------
+
+struct Animation {
+    bool scheduled;
+    int64_t start_ms;
+    uint32_t duration_ms;
+    AnimationImplementation implementation;
+    AnimationHandlers handlers;
+    void *context;
+};
+
+static Animation *s_animations[HOST_MAX_ANIMATIONS];
+static AppTimer *s_animation_timer;
+
+Animation *animation_create(void) {
+    for (int i = 0; i < HOST_MAX_ANIMATIONS; i++) {
+        if (!s_animations[i]) {
+            s_animations[i] = calloc(1, sizeof(Animation));
+            if (s_animations[i]) s_animations[i]->duration_ms = 250;
+            return s_animations[i];
+        }
+    }
+    return NULL;
+}
+
+bool animation_destroy(Animation *animation) {
+    for (int i = 0; animation && i < HOST_MAX_ANIMATIONS; i++) {
+        if (s_animations[i] == animation) {
+            s_animations[i] = NULL;
+            free(animation);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool animation_set_duration(Animation *animation, uint32_t duration_ms) {
+    if (!animation || animation->scheduled) return false;
+    animation->duration_ms = duration_ms;
+    return true;
+}
+
+bool animation_set_curve(Animation *animation, AnimationCurve curve) {
+    return animation && !animation->scheduled;
+}
+
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+    if (!animation || animation->scheduled || !implementation) return false;
+    animation->implementation = *implementation;
+    return true;
+}
+
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context) {
+    if (!animation || animation->scheduled) return false;
+    animation->handlers = callbacks;
+    animation->context = context;
+    return true;
+}
+
+void *animation_get_context(Animation *animation) {
+    return animation ? animation->context : NULL;
+}
+
+bool animation_is_scheduled(Animation *animation) {
+    return animation && animation->scheduled;
+}
+
+static void animation_stop(Animation *animation, bool finished) {
+    animation->scheduled = false;
+    if (animation->handlers.stopped) animation->handlers.stopped(animation, finished, animation->context);
+    if (animation->implementation.teardown) animation->implementation.teardown(animation);
+    animation_destroy(animation);
+}
+
+static void animations_step(int64_t now_ms, bool finish) {
+    for (int i = 0; i < HOST_MAX_ANIMATIONS; i++) {
+        Animation *animation = s_animations[i];
+        if (!animation || !animation->scheduled) continue;
+        int64_t elapsed = now_ms - animation->start_ms;
+        bool done = finish || elapsed >= animation->duration_ms;
+        AnimationProgress progress = ANIMATION_NORMALIZED_MAX;
+        if (!done) progress = (AnimationProgress)(elapsed * ANIMATION_NORMALIZED_MAX / animation->duration_ms);
+        if (animation->implementation.update) animation->implementation.update(animation, progress);
+        if (done) animation_stop(animation, true);
+    }
+}
+
+static bool animations_pending(void) {
+    for (int i = 0; i < HOST_MAX_ANIMATIONS; i++) {
+        if (s_animations[i] && s_animations[i]->scheduled) return true;
+    }
+    return false;
+}
+
+static void animations_frame(void *data) {
+    s_animation_timer = NULL;
+    animations_step(clock_ms(), false);
+    if (animations_pending()) s_animation_timer = app_timer_register(HOST_ANIMATION_FRAME_MS, animations_frame, NULL);
+}
+
+bool animation_schedule(Animation *animation) {
+    if (!animation || animation->scheduled) return false;
+    animation->scheduled = true;
+    animation->start_ms = clock_ms();
+    if (animation->implementation.setup) animation->implementation.setup(animation);
+    if (animation->handlers.started) animation->handlers.started(animation, animation->context);
+    if (!s_animation_timer) s_animation_timer = app_timer_register(HOST_ANIMATION_FRAME_MS, animations_frame, NULL);
+    return true;
+}
+
+bool animation_unschedule(Animation *animation) {
+    if (!animation || !animation->scheduled) return false;
+    animation_stop(animation, false);
+    return true;
+}
+
+void host_finish_animations(void) {
+    animations_step(clock_ms(), true);
+    if (s_animation_timer) {
+        app_timer_cancel(s_animation_timer);
+        s_animation_timer = NULL;
+    }
+}
+
+// services -------------------------------------------------------------------
+
+static TimeUnits s_tick_units;
+static TickHandler s_tick_handler;
+static BatteryStateHandler s_battery_handler;
+static BatteryChargeState s_battery = {.charge_percent = 100};
+static int s_vibes;
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+    s_tick_units = tick_units;
+    s_tick_handler = handler;
+}
+
+void tick_timer_service_unsubscribe(void) {
+    s_tick_units = 0;
+    s_tick_handler = NULL;
+}
+
+void host_advance_ms(uint32_t ms) {
+    struct tm before = *localtime(&s_now);
+    int64_t until = clock_ms() + ms;
+    timers_run(until);
+    clock_set_ms(until);
+    struct tm after = *localtime(&s_now);
+
+    TimeUnits changed = 0;
+    if (before.tm_sec != after.tm_sec) changed |= SECOND_UNIT;
+    if (before.tm_min != after.tm_min) changed |= MINUTE_UNIT;
+    if (before.tm_hour != after.tm_hour) changed |= HOUR_UNIT;
+    if (before.tm_mday != after.tm_mday) changed |= DAY_UNIT;
+    if (before.tm_mon != after.tm_mon) changed |= MONTH_UNIT;
+    if (before.tm_year != after.tm_year) changed |= YEAR_UNIT;
+
+    if (s_tick_handler && (changed & s_tick_units)) {
+        s_tick_handler(&after, changed);
+    }
+}
+
+void host_advance_time(int seconds) {
+    host_advance_ms(seconds * 1000);
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+    s_battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+    s_battery_handler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+    return s_battery;
+}
+
+static AccelTapHandler s_tap_handler;
+
+void accel_tap_service_subscribe(AccelTapHandler handler) {
+    s_tap_handler = handler;
+}
+
+void accel_tap_service_unsubscribe(void) {
+    s_tap_handler = NULL;
+}
+
+void host_tap(void) {
+    if (s_tap_handler) s_tap_handler(ACCEL_AXIS_Z, 1);
+}
+
+void host_set_battery(BatteryChargeState state) {
+    s_battery = state;
+    if (s_battery_handler) s_battery_handler(state);
+}
+
+bool quiet_time_is_active(void) {
+    return false;
+}
+
+void vibes_short_pulse(void) {
+    s_vibes++;
+}
+
+void vibes_long_pulse(void) {
+    s_vibes++;
+}
+
+void vibes_double_pulse(void) {
+    s_vibes++;
+}
+
+int host_vibe_count(void) {
+    return s_vibes;
+}
+
+// storage --------------------------------------------------------------------
+
+typedef struct {
+    bool used;
+    uint32_t key;
+    int size;
+    uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistValue;
+
+static PersistValue s_persist[HOST_MAX_PERSIST];
+
+static PersistValue *persist_find(uint32_t key) {
+    for (int i = 0; i < HOST_MAX_PERSIST; i++) {
+        if (s_persist[i].used && s_persist[i].key == key) return &s_persist[i];
+    }
+    return NULL;
+}
+
+static int persist_total(void) {
+    int total = 0;
+    for (int i = 0; i < HOST_MAX_PERSIST; i++) {
+        if (s_persist[i].used) total += s_persist[i].size;
+    }
+    return total;
+}
+
+bool persist_exists(uint32_t key) {
+    return persist_find(key) != NULL;
+}
+
+int persist_get_size(uint32_t key) {
+    PersistValue *value = persist_find(key);
+    return value ? value->size : E_DOES_NOT_EXIST;
+}
+
+int32_t persist_read_int(uint32_t key) {
+    int32_t result = 0;
+    persist_read_data(key, &result, sizeof(result));
+    return result;
+}
+
+status_t persist_write_int(uint32_t key, int32_t value) {
+    int written = persist_write_data(key, &value, sizeof(value));
+    return written < 0 ? written : S_SUCCESS;
+}
+
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size) {
+    PersistValue *value = persist_find(key);
+    if (!value) return E_DOES_NOT_EXIST;
+    int size = (size_t)value->size < buffer_size ? value->size : (int)buffer_size;
+    memcpy(buffer, value->data, size);
+    return size;
+}
+
+int persist_write_data(uint32_t key, const void *data, size_t size) {
+    if (!data || size > PERSIST_DATA_MAX_LENGTH) return E_INVALID_ARGUMENT;
+    PersistValue *value = persist_find(key);
+    int total = persist_total() - (value ? value->size : 0) + (int)size;
+    if (total > PERSIST_TOTAL_MAX_LENGTH) return E_OUT_OF_STORAGE;
+    for (int i = 0; !value && i < HOST_MAX_PERSIST; i++) {
+        if (!s_persist[i].used) value = &s_persist[i];
+    }
+    if (!value) return E_OUT_OF_STORAGE;
+    *value = (PersistValue){.used = true, .key = key, .size = (int)size};
+    memcpy(value->data, data, size);
+    return (int)size;
+}
+
+status_t persist_delete(uint32_t key) {
+    PersistValue *value = persist_find(key);
+    if (!value) return E_DOES_NOT_EXIST;
+    value->used = false;
+    return S_SUCCESS;
+}
+
+// app messages ---------------------------------------------------------------
+
+struct DictionaryIterator {
+    const Tuple *tuples;
+    int count;
+};
+
+static AppMessageInboxReceived s_inbox_received;
+static uint32_t s_inbox_size;
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+    AppMessageInboxReceived previous = s_inbox_received;
+    s_inbox_received = received_callback;
+    return previous;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+    s_inbox_size = size_inbound;
+    return APP_MSG_OK;
+}
+
+void app_message_deregister_callbacks(void) {
+    s_inbox_received = NULL;
+    s_inbox_size = 0;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+    for (int i = 0; i < iter->count; i++) {
+        if (iter->tuples[i].key == key) return (Tuple *)&iter->tuples[i];
+    }
+    return NULL;
+}
+
+bool host_app_message(const Tuple *tuples, int count) {
+    // the watch's dictionary: a count byte, then a 7-byte header per tuple
+    uint32_t size = 1;
+    for (int i = 0; i < count; i++) size += 7 + tuples[i].length;
+    if (!s_inbox_received || size > s_inbox_size) return false;
+
+    DictionaryIterator iter = {tuples, count};
+    s_inbox_received(&iter, NULL);
+    return true;
+}
+
+// app ------------------------------------------------------------------------
+
+static void (*s_event_loop)(void);
+
+void host_set_event_loop(void (*loop)(void)) {
+    s_event_loop = loop;
+}
+
+void app_event_loop(void) {
+    if (s_event_loop) {
+        s_event_loop();
+    } else {
+        host_render();
+    }
+}
+
+// APP_LOG output goes to stderr, filtered by HOST_LOG_LEVEL (default: info).
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+    static int s_max_level = -1;
+    if (s_max_level < 0) {
+        const char *env = getenv("HOST_LOG_LEVEL");
+        s_max_level = env ? atoi(env) : APP_LOG_LEVEL_INFO;
+    }
+    if (log_level > s_max_level) return;
+    fprintf(stderr, "[%d] %s:%d: ", log_level, src_filename, src_line_number);
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
@@ -1,78 +1,363 @@
 #include <pebble.h>
 #include <stdlib.h>
+#include <string.h>
 #include "big_digit.h"
+#include "heap_track.h"
+#include "render_timing.h"
+#include "transition.h"
+#include "widget_alloc.h"
 
-GBitmap *s_image_numbers[IMAGE_COUNT] = { 0 };
+RENDER_TIMING_WRAP(widget_big_digit_update)
+
+// RESOURCE_ID_DIGIT_ATLAS layout, see tools/digit_atlas.py
+#define ATLAS_MAGIC_0 'D'
+#define ATLAS_MAGIC_1 'A'
+#define ATLAS_VERSION 1
+#define ATLAS_FLAG_RLE 1
+#define ATLAS_HEADER_SIZE 10
+
+typedef struct {
+    GRect rect;   // in the atlas, always starting at x = 0
+    GPoint cell;  // top left of the glyph in its digit cell
+} DigitGlyph;
+
+static const DigitGlyph s_glyphs[IMAGE_COUNT] = DIGIT_ATLAS_GLYPHS;
+
+static GBitmap *s_atlas;
+static GBitmap *s_digits[IMAGE_COUNT]; // views into s_atlas
+static int s_atlas_refs;
+
+// atlas --------------------------------------------------------------------------
+
+// Streams a resource through a small buffer, so the compressed atlas never
+// needs a heap copy next to the decoded one.
+typedef struct {
+    ResHandle handle;
+    uint32_t offset;
+    uint32_t end;
+    uint8_t buffer[32];
+    uint8_t pos;
+    uint8_t len;
+} ResourceReader;
+
+static int reader_next(ResourceReader *reader) {
+    if (reader->pos == reader->len) {
+        if (reader->offset >= reader->end) return -1;
+        size_t count = reader->end - reader->offset;
+        if (count > sizeof(reader->buffer)) count = sizeof(reader->buffer);
+        reader->len = resource_load_byte_range(reader->handle, reader->offset, reader->buffer, count);
+        reader->offset += reader->len;
+        reader->pos = 0;
+        if (!reader->len) return -1;
+    }
+    return reader->buffer[reader->pos++];
+}
+
+// Decodes the atlas rows into the bitmap, whose rows may be padded wider
+// than the resource's. PackBits: n < 128 copies n+1 literal bytes, n >= 128
+// repeats one byte 257-n times.
+static bool atlas_unpack(ResourceReader *reader, bool rle, int row_bytes, GBitmap *bitmap) {
+    uint8_t *data = gbitmap_get_data(bitmap);
+    const int stride = gbitmap_get_bytes_per_row(bitmap);
+    const size_t total = (size_t)row_bytes * DIGIT_ATLAS_HEIGHT;
+
+    size_t out = 0;
+    while (out < total) {
+        int count = 1, repeat = -1;
+        if (rle) {
+            int n = reader_next(reader);
+            if (n < 0) return false;
+            if (n < 128) {
+                count = n + 1;
+            } else {
+                count = 257 - n;
+                if ((repeat = reader_next(reader)) < 0) return false;
+            }
+        }
+        for (; count > 0 && out < total; count--, out++) {
+            int byte = repeat >= 0 ? repeat : reader_next(reader);
+            if (byte < 0) return false;
+            data[(out / row_bytes) * stride + out % row_bytes] = byte;
+        }
+    }
+    return true;
+}
+
+static GBitmap *atlas_load(void) {
+    uint8_t header[ATLAS_HEADER_SIZE];
+    ResHandle handle = resource_get_handle(RESOURCE_ID_DIGIT_ATLAS);
+    if (resource_load_byte_range(handle, 0, header, sizeof(header)) != sizeof(header) ||
+        header[0] != ATLAS_MAGIC_0 || header[1] != ATLAS_MAGIC_1 || header[2] != ATLAS_VERSION ||
+        (header[4] | header[5] << 8) != DIGIT_ATLAS_WIDTH || (header[6] | header[7] << 8) != DIGIT_ATLAS_HEIGHT) {
+        APP_LOG(APP_LOG_LEVEL_ERROR, "BigDigitWidget: digit atlas doesn't match digit_atlas.h");
+        return NULL;
+    }
+
+    GSize size = GSize(DIGIT_ATLAS_WIDTH, DIGIT_ATLAS_HEIGHT);
+    GBitmap *atlas = heap_track_sdk("big_digit", gbitmap_create_blank(size, GBitmapFormat1Bit));
+    if (!atlas) return NULL;
+
+    ResourceReader reader = {
+        .handle = handle,
+        .offset = ATLAS_HEADER_SIZE,
+        .end = resource_size(handle),
+    };
+    if (!atlas_unpack(&reader, header[3] & ATLAS_FLAG_RLE, header[8] | header[9] << 8, atlas)) {
+        APP_LOG(APP_LOG_LEVEL_ERROR, "BigDigitWidget: digit atlas is truncated");
+        heap_track_sdk_release(atlas);
+        gbitmap_destroy(atlas);
+        return NULL;
+    }
+    return atlas;
+}
+
+static void atlas_acquire(void) {
+    if (s_atlas_refs++) return;
+    s_atlas = atlas_load();
+    if (!s_atlas) return;
+    for (int i = 0; i < IMAGE_COUNT; i++) {
+        s_digits[i] = heap_track_sdk(
+            "big_digit", gbitmap_create_as_sub_bitmap(s_atlas, s_glyphs[i].rect));
+    }
+}
+
+static void atlas_release(void) {
+    if (!s_atlas_refs || --s_atlas_refs) return;
+    for (int i = 0; i < IMAGE_COUNT; i++) {
+        heap_track_sdk_release(s_digits[i]);
+        gbitmap_destroy(s_digits[i]);
+        s_digits[i] = NULL;
+    }
+    heap_track_sdk_release(s_atlas);
+    gbitmap_destroy(s_atlas);
+    s_atlas = NULL;
+}
+
+// drawing ------------------------------------------------------------------------
+
+static inline bool glyph_bit(const uint8_t *row, int x) {
+    return (row[x >> 3] >> (x & 7)) & 1;
+}
+
+// 1-bit framebuffers share the glyph's bit order, so a row is the glyph row
+// shifted to the destination bit offset, merged one byte at a time.
+static void blit_row_1bit(uint8_t *dst, int x0, const uint8_t *src, int width) {
+    const int shift = x0 & 7;
+    const int bytes = (width + 7) >> 3;
+    const int tail = width & 7;
+    dst += x0 >> 3;
+    for (int i = 0; i < bytes; i++) {
+        uint16_t valid = (i == bytes - 1 && tail) ? (1 << tail) - 1 : 0xFF;
+        uint16_t value = (uint16_t)src[i] << shift;
+        uint16_t mask = valid << shift;
+        dst[i] = (dst[i] & ~mask) | (value & mask);
+        if (mask >> 8) {
+            dst[i + 1] = (dst[i + 1] & ~(mask >> 8)) | ((value >> 8) & (mask >> 8));
+        }
+    }
+}
+
+// 8-bit framebuffers expand each glyph nibble to four pixels through a lookup
+// of precomputed 32-bit words.
+static void blit_row_8bit(uint8_t *dst, const uint8_t *src, int width, const uint32_t lut[16],
+                          uint8_t fg, uint8_t bg) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8_t bits = src[x >> 3];
+        memcpy(dst + x, &lut[bits & 0xF], 4);
+        memcpy(dst + x + 4, &lut[bits >> 4], 4);
+    }
+    for (; x < width; x++) {
+        dst[x] = glyph_bit(src, x) ? fg : bg;
+    }
+}
+
+// Pixel-at-a-time fallback for rows that are partly off screen, including
+// the clipped edges of round displays.
+static void blit_row_clipped(const GBitmapDataRowInfo *info, bool one_bit, int x0, const uint8_t *src,
+                             int width, uint8_t fg, uint8_t bg) {
+    for (int x = 0; x < width; x++) {
+        int dx = x0 + x;
+        if (dx < info->min_x || dx > info->max_x) continue;
+        bool white = glyph_bit(src, x);
+        if (one_bit) {
+            if (white) {
+                info->data[dx >> 3] |= 1 << (dx & 7);
+            } else {
+                info->data[dx >> 3] &= ~(1 << (dx & 7));
+            }
+        } else {
+            info->data[dx] = white ? fg : bg;
+        }
+    }
+}
+
+// Clears pixels [x0, x1) of a framebuffer row to the background.
+static void clear_span(const GBitmapDataRowInfo *info, bool one_bit, int x0, int x1, uint8_t bg) {
+    if (x0 < info->min_x) x0 = info->min_x;
+    if (x1 > info->max_x + 1) x1 = info->max_x + 1;
+    if (x0 >= x1) return;
+    if (!one_bit) {
+        memset(info->data + x0, bg, x1 - x0);
+        return;
+    }
+    for (int x = x0; x < x1; x++) {
+        info->data[x >> 3] &= ~(1 << (x & 7));
+    }
+}
+
+// Paints a whole digit cell: the glyph, which is cropped to its ink, at
+// `glyph` (relative to the cell) and background everywhere else, on the screen
+// rows from `top` up to `bottom`. Glyphs start at x = 0 in the atlas, so every
+// glyph row starts on a byte.
+static void glyph_blit(GBitmap *fb, GRect cell, int top, int bottom, GRect glyph, const GBitmap *digit) {
+    const GRect fb_bounds = gbitmap_get_bounds(fb);
+    if (top < fb_bounds.origin.y) top = fb_bounds.origin.y;
+    if (bottom > fb_bounds.origin.y + fb_bounds.size.h) bottom = fb_bounds.origin.y + fb_bounds.size.h;
+    const bool one_bit = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+    const uint8_t fg = GColorWhite.argb;
+    const uint8_t bg = GColorBlack.argb;
+    const uint16_t stride = gbitmap_get_bytes_per_row(digit);
+    const uint8_t *rows = gbitmap_get_data(digit) + gbitmap_get_bounds(digit).origin.y * stride;
+    const int cell_x1 = cell.origin.x + cell.size.w;
+    const int glyph_x0 = cell.origin.x + glyph.origin.x;
+    const int glyph_x1 = glyph_x0 + glyph.size.w;
+
+    uint32_t lut[16];
+    if (!one_bit) {
+        for (int n = 0; n < 16; n++) {
+            uint8_t px[4];
+            for (int b = 0; b < 4; b++) px[b] = (n >> b) & 1 ? fg : bg;
+            memcpy(&lut[n], px, 4);
+        }
+    }
+
+    for (int y = 0; y < cell.size.h; y++) {
+        int dy = cell.origin.y + y;
+        if (dy < top || dy >= bottom) continue;
+
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, dy);
+        int gy = y - glyph.origin.y;
+        if (gy < 0 || gy >= glyph.size.h) {
+            clear_span(&info, one_bit, cell.origin.x, cell_x1, bg);
+            continue;
+        }
+
+        clear_span(&info, one_bit, cell.origin.x, glyph_x0, bg);
+        const uint8_t *src = rows + gy * stride;
+        if (glyph_x0 < info.min_x || glyph_x1 - 1 > info.max_x) {
+            blit_row_clipped(&info, one_bit, glyph_x0, src, glyph.size.w, fg, bg);
+        } else if (one_bit) {
+            blit_row_1bit(info.data, glyph_x0, src, glyph.size.w);
+        } else {
+            blit_row_8bit(info.data + glyph_x0, src, glyph.size.w, lut, fg, bg);
+        }
+        clear_span(&info, one_bit, glyph_x1, cell_x1, bg);
+    }
+}
+
+// The glyph's place in the cell, cut to the layer if it is smaller.
+static GRect glyph_dest(int number, GRect bounds) {
+    const DigitGlyph *glyph = &s_glyphs[number];
+    GRect dest = GRect(glyph->cell.x, glyph->cell.y, glyph->rect.size.w, glyph->rect.size.h);
+    if (dest.size.w > bounds.size.w - dest.origin.x) dest.size.w = bounds.size.w - dest.origin.x;
+    if (dest.size.h > bounds.size.h - dest.origin.y) dest.size.h = bounds.size.h - dest.origin.y;
+    return dest;
+}
 
 void widget_big_digit_update(Layer *layer, GContext *ctx) {
-    BigDigitWidget *widget = *(BigDigitWidget **)layer_get_data(layer);
-    GBitmap *bitmap = s_image_numbers[widget->number];
-    if (bitmap){
-        graphics_draw_bitmap_in_rect(ctx, bitmap, layer_get_bounds(layer));
+    BigDigitWidget *widget = widget_layer_get(layer);
+    GBitmap *digit = s_digits[widget->number];
+    GRect bounds = layer_get_bounds(layer);
+    GRect dest = glyph_dest(widget->number, bounds);
+
+    GBitmap *fb = digit ? graphics_capture_frame_buffer(ctx) : NULL;
+    if (!fb) {
+        graphics_context_set_fill_color(ctx, GColorBlack);
+        graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+        if (digit && dest.size.w > 0 && dest.size.h > 0) {
+            dest.origin.x += bounds.origin.x;
+            dest.origin.y += bounds.origin.y;
+            graphics_context_set_compositing_mode(ctx, GCompOpAssign);
+            graphics_draw_bitmap_in_rect(ctx, digit, dest);
+        }
+        return;
+    }
+    GRect cell = {layer_convert_point_to_screen(layer, bounds.origin), bounds.size};
+    const int top = cell.origin.y, bottom = cell.origin.y + cell.size.h;
+    if (widget->offset && s_digits[widget->previous]) {
+        // sliding: the previous digit leaves upwards as the new one comes up from below
+        GRect previous_cell = cell;
+        previous_cell.origin.y += widget->offset - cell.size.h;
+        glyph_blit(fb, previous_cell, top, bottom, glyph_dest(widget->previous, bounds), s_digits[widget->previous]);
+        cell.origin.y += widget->offset;
     }
+    glyph_blit(fb, cell, top, bottom, dest, digit);
+    graphics_release_frame_buffer(ctx, fb);
 }
 
+// widget -------------------------------------------------------------------------
+
 BigDigitWidget *widget_big_digit_create(GPoint origin, int number) {
-    if (!s_image_numbers[0]) {
-        widget_big_digit_load_images();
-    }
     if (number < 0 || number > 9) return NULL;
-    
-    BigDigitWidget *widget = malloc(sizeof(BigDigitWidget));
-    if (!widget) return NULL;
 
     GRect bounds = GRect(origin.x, origin.y, IMG_WIDTH, IMG_HEIGHT);
-    widget->layer = layer_create_with_data(bounds, sizeof(BigDigitWidget *));
-    if (!widget->layer) {
-        free(widget);
-        return NULL;
-    }
+    BigDigitWidget *widget = widget_layer_create("big_digit", bounds, sizeof(BigDigitWidget));
+    if (!widget) return NULL;
 
-    // Attach user data
-    *(BigDigitWidget **)layer_get_data(widget->layer) = widget;
-    layer_set_update_proc(widget->layer, widget_big_digit_update);
+    layer_set_update_proc(widget->layer, RENDER_TIMED(widget_big_digit_update));
 
     widget->number = number;
+    widget->previous = number;
+    widget->offset = 0;
+    atlas_acquire();
 
     return widget;
 }
 
 void widget_big_digit_set(BigDigitWidget *widget, int number) {
     if (!widget) return;
-    if (number == widget->number) return;
     if (number < 0 || number > 9) return;
+    const bool sliding = widget->offset != 0;
+    transition_stop(widget);
+    widget->offset = 0;
+    if (number == widget->number && !sliding) return;
 
     widget->number = number;
-    
-    // bitmap_layer_set_bitmap(widget->layer, s_image_numbers[number]);
+
     layer_mark_dirty(widget->layer);
 }
 
+static void big_digit_apply_offset(void *digit, int32_t offset) {
+    BigDigitWidget *widget = digit;
+    if (offset == widget->offset) return;
+    widget->offset = offset;
+    layer_mark_dirty(widget->layer);
+}
+
+void widget_big_digit_slide(BigDigitWidget *widget, int number, uint32_t duration_ms) {
+    if (!widget || number == widget->number || number < 0 || number > 9) return;
+    widget->previous = widget->number;
+    widget->number = number;
+    transition_start(widget, widget->layer, big_digit_apply_offset, layer_get_bounds(widget->layer).size.h, 0,
+                     duration_ms);
+}
+
 void widget_big_digit_destroy(BigDigitWidget *widget) {
     if (widget) {
-        layer_destroy(widget->layer);
-        free(widget);
+        transition_stop(widget);
+        atlas_release();
+        widget_layer_destroy(widget);
     }
 }
 
-void widget_big_digit_load_images() {
-    s_image_numbers[0] = gbitmap_create_with_resource(RESOURCE_ID_ZERO);
-    s_image_numbers[1] = gbitmap_create_with_resource(RESOURCE_ID_ONE);
-    s_image_numbers[2] = gbitmap_create_with_resource(RESOURCE_ID_TWO);
-    s_image_numbers[3] = gbitmap_create_with_resource(RESOURCE_ID_THREE);
-    s_image_numbers[4] = gbitmap_create_with_resource(RESOURCE_ID_FOUR);
-    s_image_numbers[5] = gbitmap_create_with_resource(RESOURCE_ID_FIVE);
-    s_image_numbers[6] = gbitmap_create_with_resource(RESOURCE_ID_SIX);
-    s_image_numbers[7] = gbitmap_create_with_resource(RESOURCE_ID_SEVEN);
-    s_image_numbers[8] = gbitmap_create_with_resource(RESOURCE_ID_EIGHT);
-    s_image_numbers[9] = gbitmap_create_with_resource(RESOURCE_ID_NINE);
+// widget class -------------------------------------------------------------------
+
+static void big_digit_destroy(void *widget) {
+    widget_big_digit_destroy(widget);
 }
 
-void widget_big_digit_unload_images(void) {
-    for (int i = 0; i < IMAGE_COUNT; i++) {
-        if (s_image_numbers[i]) {
-            gbitmap_destroy(s_image_numbers[i]);
-            s_image_numbers[i] = NULL;
-        }
-    }
-}
\ No newline at end of file
+const WidgetClass BIG_DIGIT_WIDGET_CLASS = {
+    .name = "big_digit",
+    .destroy = big_digit_destroy,
+};
@@ -1,21 +1,33 @@
 #pragma once
 #include <pebble.h>
+#include "../generated/digit_atlas.h"
+#include "widget.h"
 
 #define IMAGE_COUNT 10
-#define IMG_WIDTH 69
-#define IMG_HEIGHT 69
+#define IMG_WIDTH DIGIT_CELL_SIZE
+#define IMG_HEIGHT DIGIT_CELL_SIZE
 
-extern GBitmap *s_image_numbers[IMAGE_COUNT];
+// Digits are rendered per platform at build time by tools/digit_atlas.py into
+// one 1-bit atlas, RESOURCE_ID_DIGIT_ATLAS, with the glyph rects in
+// digit_atlas.h. The atlas is loaded with the first widget and freed with the
+// last one; each digit is a sub-bitmap view into it.
+#define BIG_DIGIT_ATLAS_BYTES (((DIGIT_ATLAS_WIDTH + 31) / 32 * 4) * DIGIT_ATLAS_HEIGHT)
 
 typedef struct {
     Layer *layer;
     int number; // The number to display
+
+    // while sliding from `previous`: rows the new digit still has to rise
+    int previous;
+    int offset;
 } BigDigitWidget;
 
 BigDigitWidget *widget_big_digit_create(GPoint origin, int number);
 void widget_big_digit_set(BigDigitWidget *widget, int number);
+// Slides `number` in from below, pushing the current digit out at the top.
+void widget_big_digit_slide(BigDigitWidget *widget, int number, uint32_t duration_ms);
 void widget_big_digit_destroy(BigDigitWidget *widget);
 void widget_big_digit_update(Layer *layer, GContext *ctx);
 
-void widget_big_digit_load_images(void);
-void widget_big_digit_unload_images(void);
\ No newline at end of file
+// What a digit shows is up to the face, so the class has no tick handler.
+extern const WidgetClass BIG_DIGIT_WIDGET_CLASS;
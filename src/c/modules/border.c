@@ -1,119 +1,366 @@
 #include <pebble.h>
 #include "border.h"
+#include "fb_draw.h"
+#include "render_timing.h"
+#include "transition.h"
+#include "widget_alloc.h"
+
+RENDER_TIMING_WRAP(widget_border_update)
+
+// Splits the path into its segments and gives each a share of the steps
+// proportional to its length. All divisions happen here, so the draw proc
+// only needs a table walk and a multiply.
+static void border_build_segments(BorderWidget *widget, GSize size) {
+  const int W = size.w;
+  const int H = size.h;
+  const int T = widget->thickness;
+
+  const int len[BORDER_SEGMENTS] = {
+    W / 2,     // top-right half
+    H - T,     // right
+    W - T,     // bottom
+    H - T,     // left
+    W / 2 - T, // top-left half
+  };
+
+  int perimeter = 0;
+  for (int i = 0; i < BORDER_SEGMENTS; i++) perimeter += len[i];
+
+  int steps_total = 0;
+  for (int i = 0; i < BORDER_SEGMENTS; i++) {
+    widget->segments[i].steps = perimeter > 0 ? (widget->steps * len[i]) / perimeter : 0;
+    steps_total += widget->segments[i].steps;
+  }
+  // absorb rounding
+  widget->segments[BORDER_SEGMENTS - 1].steps += widget->steps - steps_total;
+
+  int start = 0;
+  int first_step = 0;
+  for (int i = 0; i < BORDER_SEGMENTS; i++) {
+    BorderSegment *segment = &widget->segments[i];
+    segment->length = len[i];
+    segment->start = start;
+    segment->first_step = first_step;
+    segment->scale = segment->steps > 0
+      ? (((uint64_t)len[i] << 32) + segment->steps - 1) / segment->steps
+      : 0;
+    start += len[i];
+    first_step += segment->steps;
+  }
+
+  widget->size = size;
+  widget->drawn = -1;
+}
+
+// Path position reached at `step`: completed segments in full, the current
+// one proportionally.
+static int border_position(const BorderWidget *widget, int step) {
+  for (int i = BORDER_SEGMENTS - 1; i >= 0; i--) {
+    const BorderSegment *segment = &widget->segments[i];
+    if (step < segment->first_step) continue;
+
+    int elapsed = step - segment->first_step;
+    if (elapsed >= segment->steps) return segment->start + segment->length;
+    return segment->start + (int)((elapsed * segment->scale) >> 32);
+  }
+  return 0;
+}
+
+#define QUARTER_ANGLE (TRIG_MAX_ANGLE / 4)
+
+// Builds the ring table for `size`: the pixels of the top-right quadrant whose
+// centers lie within `thickness` of the edge of the largest centered circle,
+// sorted clockwise. Distances are in half pixels so that pixel centers fall on
+// whole numbers. Leaves the table empty if there is no memory for it.
+static void border_build_ring(BorderWidget *widget, GSize size) {
+  widget_free(widget->ring);
+  widget->ring = NULL;
+  widget->ring_pixels = 0;
+
+  const int R = (size.w < size.h ? size.w : size.h) / 2;
+  const int T = widget->thickness < R ? widget->thickness : R;
+  const int outer = 4 * R * R;
+  const int inner = 4 * (R - T) * (R - T);
+
+  int count = 0;
+  for (int v = 0; v < R; v++) {
+    for (int u = 0; u < R; u++) {
+      const int d = (2 * u + 1) * (2 * u + 1) + (2 * v + 1) * (2 * v + 1);
+      if (d < outer && d >= inner) count++;
+    }
+  }
+  if (!count) return;
+  widget->ring = widget_alloc("border", count * sizeof(BorderRingPixel));
+  if (!widget->ring) return;
+
+  // insertion sort: built once per layer size
+  for (int v = 0; v < R; v++) {
+    for (int u = 0; u < R; u++) {
+      const int d = (2 * u + 1) * (2 * u + 1) + (2 * v + 1) * (2 * v + 1);
+      if (d >= outer || d < inner) continue;
+      BorderRingPixel pixel = {.u = u, .v = v, .angle = atan2_lookup(2 * u + 1, 2 * v + 1)};
+      int i = widget->ring_pixels++;
+      for (; i > 0 && widget->ring[i - 1].angle > pixel.angle; i--) widget->ring[i] = widget->ring[i - 1];
+      widget->ring[i] = pixel;
+    }
+  }
+}
+
+// Ring pixels before `step`: whole quadrants, then a binary search of the
+// table for the angle into the current one.
+static int border_ring_position(const BorderWidget *widget, int step) {
+  if (step >= widget->steps) return 4 * widget->ring_pixels;
+  // 32 bits hold step * TRIG_MAX_ANGLE for up to 65535 steps
+  int32_t angle = (uint32_t)step * TRIG_MAX_ANGLE / widget->steps;
+  const int quadrant = angle / QUARTER_ANGLE;
+  angle -= quadrant * QUARTER_ANGLE;
+
+  int lo = 0, hi = widget->ring_pixels;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (widget->ring[mid].angle < angle) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return quadrant * widget->ring_pixels + lo;
+}
+
+// Paints ring pixels `from` to `to`, turning the quadrant's pixels into place.
+static void border_fill_ring(GContext *ctx, FbDraw *draw, const BorderWidget *widget, int from, int to) {
+  const int cx = widget->size.w / 2;
+  const int cy = widget->size.h / 2;
+  if (!draw) graphics_context_set_stroke_color(ctx, GColorWhite);
+
+  for (int i = from; i < to; i++) {
+    const BorderRingPixel *pixel = &widget->ring[i % widget->ring_pixels];
+    GPoint point;
+    switch (i / widget->ring_pixels) {
+      case 0: // top-right
+        point = GPoint(cx + pixel->u, cy - 1 - pixel->v);
+        break;
+      case 1: // bottom-right
+        point = GPoint(cx + pixel->v, cy + pixel->u);
+        break;
+      case 2: // bottom-left
+        point = GPoint(cx - 1 - pixel->u, cy + pixel->v);
+        break;
+      default: // top-left
+        point = GPoint(cx - 1 - pixel->v, cy - 1 - pixel->u);
+        break;
+    }
+    if (draw) {
+      fb_draw_pixel(draw, point, GColorWhite);
+    } else {
+      graphics_draw_pixel(ctx, point);
+    }
+  }
+}
+
+// Called whenever the step or the geometry changes, so drawing only reads it.
+static void border_update_position(BorderWidget *widget) {
+  widget->position = widget->ring ? border_ring_position(widget, widget->step) : border_position(widget, widget->step);
+}
+
+// The path for `size`, and in round mode its ring table.
+static void border_build(BorderWidget *widget, GSize size) {
+  border_build_segments(widget, size);
+  if (widget->round) {
+    border_build_ring(widget, size);
+  } else if (widget->ring) {
+    widget_free(widget->ring);
+    widget->ring = NULL;
+    widget->ring_pixels = 0;
+  }
+  border_update_position(widget);
+}
 
 BorderWidget *widget_border_create(GRect bounds, int thickness) {
-  BorderWidget *widget = malloc(sizeof(BorderWidget));
+  BorderWidget *widget = widget_layer_create("border", bounds, sizeof(BorderWidget));
   if (!widget) return NULL;
-  
-  widget->layer = layer_create_with_data(bounds, sizeof(BorderWidget *));
-  if (!widget->layer) {
-    free(widget);
-    return NULL;
-  }
 
-  // Attach user data
-  *(BorderWidget **)layer_get_data(widget->layer) = widget;
-  layer_set_update_proc(widget->layer, widget_border_update);
+  layer_set_update_proc(widget->layer, RENDER_TIMED(widget_border_update));
 
-  widget->progress = 0.0f;
+  widget->progress = 0;
   widget->thickness = thickness;
-
-  layer_set_update_proc(widget->layer, widget_border_update);
+  widget->steps = BORDER_DEFAULT_STEPS;
+  widget->step = 0;
+  widget->incremental = false;
+  widget->round = PBL_IF_ROUND_ELSE(true, false);
+  widget->ring = NULL;
+  widget->ring_pixels = 0;
+  border_build(widget, bounds.size);
   return widget;
 }
 
-void widget_border_update(Layer *layer, GContext *ctx) {
-    BorderWidget *widget = *(BorderWidget **)layer_get_data(layer);
-    GRect bounds = layer_get_bounds(layer);
-    
-    graphics_context_set_fill_color(ctx, GColorBlack);
-    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-    
-  const int W = bounds.size.w;
-  const int H = bounds.size.h;
+static void border_fill_rect(GContext *ctx, FbDraw *draw, GRect rect, GColor color) {
+  if (draw) {
+    fb_draw_fill_rect(draw, rect, 0, GCornerNone, color);
+  } else {
+    graphics_context_set_fill_color(ctx, color);
+    graphics_fill_rect(ctx, rect, 0, GCornerNone);
+  }
+}
+
+// Paints the part of the path between positions `from` and `to`, into `draw`
+// if it is given.
+static void border_fill_path(GContext *ctx, FbDraw *draw, const BorderWidget *widget, int from, int to) {
+  const int W = widget->size.w;
+  const int H = widget->size.h;
   const int T = widget->thickness;
 
-  const int px_top_half  = W / 2;
-  const int px_right     = H - T;
-  const int px_bottom    = W - T;
-  const int px_left      = H - T;
-  const int px_top_left  = (W / 2) - T;
+  for (int i = 0; i < BORDER_SEGMENTS; i++) {
+    const BorderSegment *segment = &widget->segments[i];
+    if (segment->start >= to) break;
 
-  const int perimeter = px_top_half + px_right + px_bottom + px_left + px_top_left;
+    int a = from - segment->start;
+    int b = to - segment->start;
+    if (a < 0) a = 0;
+    if (b > segment->length) b = segment->length;
+    if (a >= b) continue;
 
-  int dur_top_half  = (60 * px_top_half) / perimeter;
-  int dur_right     = (60 * px_right)    / perimeter;
-  int dur_bottom    = (60 * px_bottom)   / perimeter;
-  int dur_left      = (60 * px_left)     / perimeter;
-  int dur_top_left  = (60 * px_top_left) / perimeter;
+    switch (i) {
+      case 0: // top-right (left → right), no vertical inset
+        border_fill_rect(ctx, draw, GRect(W / 2 + a, 0, b - a, T), GColorWhite);
+        break;
+      case 1: // right (top → bottom), inset by T
+        border_fill_rect(ctx, draw, GRect(W - T, T + a, T, b - a), GColorWhite);
+        break;
+      case 2: // bottom (right → left), inset by T from bottom and sides
+        border_fill_rect(ctx, draw, GRect(W - T - b, H - T, b - a, T), GColorWhite);
+        break;
+      case 3: // left (bottom → top), inset from all edges
+        border_fill_rect(ctx, draw, GRect(0, H - T - b, T, b - a), GColorWhite);
+        break;
+      default: // top-left (left → right), inset by T from top and sides
+        border_fill_rect(ctx, draw, GRect(T + a, 0, b - a, T), GColorWhite);
+        break;
+    }
+  }
+}
 
-  int dur_total = dur_top_half + dur_right + dur_bottom + dur_left + dur_top_left;
-  if (dur_total < 60) dur_top_left += 60 - dur_total; // absorb rounding
+void widget_border_update(Layer *layer, GContext *ctx) {
+  BorderWidget *widget = widget_layer_get(layer);
+  GRect bounds = layer_get_bounds(layer);
 
-  int m = localtime(&(time_t){time(NULL)})->tm_min;
-  int elapsed = m;
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "BorderWidget: elapsed %d seconds", elapsed);
+  if (bounds.size.w != widget->size.w || bounds.size.h != widget->size.h) {
+    border_build(widget, bounds.size);
+  }
 
-  graphics_context_set_fill_color(ctx, GColorBlack);
-  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-  graphics_context_set_fill_color(ctx, GColorWhite);
+  const int position = widget->position;
 
-  if (elapsed < dur_top_half) {
-    // Top-right (left → right), full width, no vertical inset
-    int px = (W / 2) * elapsed / dur_top_half;
-    graphics_fill_rect(ctx, GRect(W / 2, 0, px, T), 0, GCornerNone);
+  // straight into the framebuffer, or through the SDK while it is busy
+  FbDraw fb_draw;
+  FbDraw *draw = fb_draw_begin(&fb_draw, ctx, layer) ? &fb_draw : NULL;
 
-  } else if ((elapsed -= dur_top_half) < dur_right) {
-    // Top-right done
-    graphics_fill_rect(ctx, GRect(W / 2, 0, W / 2, T), 0, GCornerNone);
+  int from = widget->drawn;
+  if (!widget->incremental || from < 0 || from > position) {
+    // Full repaint: first frame, invalidated, or wrapped back to the start.
+    border_fill_rect(ctx, draw, bounds, GColorBlack);
+    from = 0;
+  }
 
-    // Right edge (top → bottom), inset by T
-    int px = (H - T) * elapsed / dur_right;
-    graphics_fill_rect(ctx, GRect(W - T, T, T, px), 0, GCornerNone);
+  if (widget->ring) {
+    border_fill_ring(ctx, draw, widget, from, position);
+  } else {
+    border_fill_path(ctx, draw, widget, from, position);
+  }
+  if (draw) fb_draw_end(draw);
+  widget->drawn = position;
+}
 
-  } else if ((elapsed -= dur_right) < dur_bottom) {
-    // Top-right + right full
-    graphics_fill_rect(ctx, GRect(W / 2, 0, W / 2, T), 0, GCornerNone);
-    graphics_fill_rect(ctx, GRect(W - T, T, T, H - T), 0, GCornerNone);
+// Sweep frames and set values that don't move the border by a step aren't redrawn.
+static void border_apply_progress(void *border, int32_t progress) {
+  BorderWidget *widget = border;
+  int step = ((uint32_t)progress * widget->steps + PROGRESS_MAX / 2) / PROGRESS_MAX;
+  widget->progress = progress;
+  if (step != widget->step) {
+    widget->step = step;
+    border_update_position(widget);
+    layer_mark_dirty(widget->layer);
+  }
+}
 
-    // Bottom (right → left), inset by T from bottom and sides
-    int px = (W - T) * elapsed / dur_bottom;
-    graphics_fill_rect(ctx, GRect(W - px - T, H - T, px, T), 0, GCornerNone);
+void widget_border_sweep(BorderWidget *widget, int32_t progress, uint32_t duration_ms) {
+  if (widget) {
+    if (progress < 0) progress = 0;
+    if (progress > PROGRESS_MAX) progress = PROGRESS_MAX;
+    transition_start(widget, widget->layer, border_apply_progress, widget->progress, progress, duration_ms);
+  }
+}
 
-  } else if ((elapsed -= dur_bottom) < dur_left) {
-    // Top + right + bottom full
-    graphics_fill_rect(ctx, GRect(W / 2, 0, W / 2, T), 0, GCornerNone);
-    graphics_fill_rect(ctx, GRect(W - T, T, T, H - T), 0, GCornerNone);
-    graphics_fill_rect(ctx, GRect(0, H - T, W - T, T), 0, GCornerNone);
+// Progress is quantized to the nearest step here rather than in the draw proc.
+void widget_border_set_progress(BorderWidget *widget, int32_t progress) {
+  if (widget) {
+    transition_stop(widget);
+    if (progress < 0) progress = 0;
+    if (progress > PROGRESS_MAX) progress = PROGRESS_MAX;
+    border_apply_progress(widget, progress);
+  }
+}
 
-    // Left (bottom → top), inset from all edges
-    int px = (H - T) * elapsed / dur_left;
-    graphics_fill_rect(ctx, GRect(0, H - T - px, T, px), 0, GCornerNone);
+void widget_border_set_resolution(BorderWidget *widget, int steps) {
+  if (widget && steps > 0 && steps != widget->steps) {
+    widget->steps = steps;
+    border_build_segments(widget, widget->size);
+    widget_border_set_progress(widget, widget->progress);
+    border_update_position(widget);
+    layer_mark_dirty(widget->layer);
 
-  } else {
-    // All previous full
-    graphics_fill_rect(ctx, GRect(W / 2, 0, W / 2, T), 0, GCornerNone);
-    graphics_fill_rect(ctx, GRect(W - T, T, T, H - T), 0, GCornerNone);
-    graphics_fill_rect(ctx, GRect(0, H - T, W - T, T), 0, GCornerNone);
-    graphics_fill_rect(ctx, GRect(0, 0, T, H - T), 0, GCornerNone);
+    // a second per step needs second ticks, if the scheduler drives the border
+    widget_scheduler_set_units(widget, steps == SECONDS_PER_HOUR ? SECOND_UNIT : BORDER_WIDGET_CLASS.tick_units);
+    widget_scheduler_subscribe();
+  }
+}
+
+void widget_border_set_round(BorderWidget *widget, bool round) {
+  if (widget && round != widget->round) {
+    widget->round = round;
+    border_build(widget, widget->size);
+    widget_border_invalidate(widget);
+  }
+}
 
-    elapsed -= dur_left;
-    // Top-left (left → right), inset by T from top and sides
-    int px = (W / 2 - T) * elapsed / dur_top_left;
-    graphics_fill_rect(ctx, GRect(T, 0, px, T), 0, GCornerNone);
+void widget_border_set_incremental(BorderWidget *widget, bool incremental) {
+  if (widget) {
+    widget->incremental = incremental;
+    widget_border_invalidate(widget);
   }
 }
 
-void widget_border_set_progress(BorderWidget *widget, float progress) {
+void widget_border_invalidate(BorderWidget *widget) {
   if (widget) {
-    widget->progress = progress;
+    widget->drawn = -1;
     layer_mark_dirty(widget->layer);
   }
 }
 
 void widget_border_destroy(BorderWidget *widget) {
   if (widget) {
-    layer_destroy(widget->layer);
-    free(widget);
+    transition_stop(widget);
+    widget_free(widget->ring);
+    widget_layer_destroy(widget);
   }
 }
+
+static void border_destroy(void *widget) {
+  widget_border_destroy(widget);
+}
+
+static void border_on_tick(void *data, struct tm *tick_time, TimeUnits units_changed) {
+  BorderWidget *widget = data;
+  if (widget->steps == SECONDS_PER_HOUR) {
+    int second = tick_time->tm_min * SECONDS_PER_MINUTE + tick_time->tm_sec;
+    widget_border_set_progress(widget, PROGRESS_FRACTION(second, SECONDS_PER_HOUR));
+  } else {
+    widget_border_set_progress(widget, PROGRESS_FRACTION(tick_time->tm_min, MINUTES_PER_HOUR));
+  }
+}
+
+const WidgetClass BORDER_WIDGET_CLASS = {
+  .name = "border",
+  .destroy = border_destroy,
+  .on_tick = border_on_tick,
+  .tick_units = MINUTE_UNIT,
+};
@@ -1,13 +1,78 @@
 #pragma once
 #include <pebble.h>
+#include "progress.h"
+#include "widget.h"
+
+#define BORDER_SEGMENTS 5
+#define BORDER_DEFAULT_STEPS 60
+
+// One straight run of the border path. The path starts at 12 o'clock and runs
+// clockwise: top-right, right, bottom, left, top-left.
+typedef struct {
+    int length;     // pixels along the path
+    int start;      // path position of the segment's first pixel
+    int first_step; // step at which the segment starts filling
+    int steps;      // steps spent filling the segment
+    uint64_t scale; // pixels per step in Q32, rounded up so the product floors exactly
+} BorderSegment;
+
+// One pixel of the round border's top-right quadrant, `u` right of and `v`
+// above the center; the other quadrants are the same pixels turned by 90°.
+typedef struct {
+    uint8_t u;
+    uint8_t v;
+    uint16_t angle; // of the pixel's center, clockwise from 12 o'clock
+} BorderRingPixel;
 
 typedef struct {
     Layer *layer;
-    float progress;
+    int32_t progress; // fraction of PROGRESS_MAX
     int thickness;
+
+    // geometry, rebuilt when the resolution or the layer size changes
+    int steps; // progress resolution, e.g. 60 for minutes, 3600 for seconds
+    int step;  // progress quantized to steps
+    int position; // path or ring pixels reached at `step`, kept with it for the draw proc
+    GSize size;
+    BorderSegment segments[BORDER_SEGMENTS];
+
+    // round mode: a ring around the bezel, whose pixels are taken in
+    // clockwise order from a table built for the layer size
+    bool round;
+    BorderRingPixel *ring; // one quadrant, sorted by angle
+    int ring_pixels;       // per quadrant
+
+    // incremental redraw
+    bool incremental;
+    int drawn; // perimeter pixels already on screen, -1 when a full repaint is due
 } BorderWidget;
 
 BorderWidget *widget_border_create(GRect bounds, int thickness);
 void widget_border_destroy(BorderWidget *widget);
 void widget_border_update(Layer *layer, GContext *ctx);
-void widget_border_set_progress(BorderWidget *widget, float progress);
\ No newline at end of file
+// Redraws only if `progress` moves the border by a step.
+void widget_border_set_progress(BorderWidget *widget, int32_t progress);
+
+// Sweeps the border to `progress` instead of jumping there.
+void widget_border_sweep(BorderWidget *widget, int32_t progress, uint32_t duration_ms);
+
+// On round displays the border starts out as a ring around the bezel, drawn
+// pixel by pixel from a polar lookup table; turn that off for the rectangle.
+void widget_border_set_round(BorderWidget *widget, bool round);
+
+// Number of distinct positions the border moves through from empty to full.
+// A border added to the widget scheduler is moved to second ticks at
+// SECONDS_PER_HOUR, and back to minute ticks otherwise.
+void widget_border_set_resolution(BorderWidget *widget, int steps);
+
+// In incremental mode each redraw paints only the stretch of the perimeter
+// added since the previous frame. This relies on the framebuffer still holding
+// that frame, so nothing else may paint over the border between redraws: give
+// the window a GColorClear background and call widget_border_invalidate()
+// whenever the screen content was lost (e.g. from the window's appear handler).
+void widget_border_set_incremental(BorderWidget *widget, bool incremental);
+void widget_border_invalidate(BorderWidget *widget);
+
+// Ticks fill the border over the hour, by the minute, or by the second at a
+// resolution of SECONDS_PER_HOUR.
+extern const WidgetClass BORDER_WIDGET_CLASS;
@@ -0,0 +1,151 @@
+#include <pebble.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calendar.h"
+#include "fb_draw.h"
+#include "fb_cache.h"
+#include "render_timing.h"
+#include "widget_alloc.h"
+
+RENDER_TIMING_WRAP(widget_calendar_update)
+
+#define CELL_WIDTH 19
+#define GUTTER 1
+#define HIGHLIGHT_HEIGHT 26
+
+static const char *DAY_LETTERS[] = {"Su", "Mo", "Tu", "We", "Th", "Fr", "Sa"};
+static const uint8_t MONTH_DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+int calendar_days_in_month(int year, int month) {
+    if (month != 1) return MONTH_DAYS[month];
+    int y = year + 1900;
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return leap ? 29 : 28;
+}
+
+// Day of the month `offset` days away from the widget's date, for offsets
+// within a month either way.
+static int calendar_day_at(const CalendarWidget *widget, int offset) {
+    int day = widget->day + offset;
+    if (day < 1) {
+        int month = widget->month ? widget->month - 1 : 11;
+        return day + calendar_days_in_month(widget->month ? widget->year : widget->year - 1, month);
+    }
+    int length = calendar_days_in_month(widget->year, widget->month);
+    return day > length ? day - length : day;
+}
+
+// drawing ------------------------------------------------------------------------
+
+static void draw_day_box(GContext *ctx, int x, const char *label, GFont font, int y_offset) {
+    GRect box = GRect(x, y_offset, CELL_WIDTH, 14);
+    graphics_draw_text(ctx, label, font, box, GTextOverflowModeFill, GTextAlignmentCenter, NULL);
+}
+
+// Today's box, straight into the framebuffer when it is free.
+static void draw_highlight_box(GContext *ctx, Layer *layer, int x) {
+    const GRect box = GRect(x, 0, CELL_WIDTH, HIGHLIGHT_HEIGHT);
+    FbDraw draw;
+    if (fb_draw_begin(&draw, ctx, layer)) {
+        fb_draw_fill_rect(&draw, box, 1, GCornersAll, GColorWhite);
+        fb_draw_end(&draw);
+    } else {
+        graphics_context_set_fill_color(ctx, GColorWhite);
+        graphics_fill_rect(ctx, box, 1, GCornersAll);
+    }
+}
+
+static void calendar_draw(GContext *ctx, Layer *layer, const CalendarWidget *widget, GRect bounds) {
+    // Draw line to divide weekdays from weekend (Sat Sun)
+    int x = (CELL_WIDTH + GUTTER) * 5;
+    graphics_context_set_stroke_color(ctx, GColorWhite);
+    graphics_draw_line(ctx, GPoint(x, 0), GPoint(x, bounds.size.h));
+
+    // Columns run Monday to Sunday, so today is column (weekday + 6) % 7.
+    const int today_column = (widget->weekday + 6) % 7;
+    for (int i = 0; i < 7; i++) {
+        int x = (i + 1) * GUTTER + i * CELL_WIDTH;
+        bool is_today = i == today_column;
+
+        if (is_today) {
+            draw_highlight_box(ctx, layer, x);
+            graphics_context_set_text_color(ctx, GColorBlack);
+        } else {
+            graphics_context_set_text_color(ctx, GColorWhite);
+        }
+        GFont font = is_today ? widget->bold_font : widget->font;
+
+        char day_text[3];
+        draw_day_box(ctx, x, DAY_LETTERS[(i + 1) % 7], font, -3);
+        snprintf(day_text, sizeof(day_text), "%d", calendar_day_at(widget, i - today_column));
+        draw_day_box(ctx, x, day_text, font, 10);
+
+        graphics_context_set_text_color(ctx, GColorWhite);
+        snprintf(day_text, sizeof(day_text), "%d", calendar_day_at(widget, i - today_column + 7));
+        draw_day_box(ctx, x, day_text, widget->font, 24);
+    }
+}
+
+void widget_calendar_update(Layer *layer, GContext *ctx) {
+    CalendarWidget *widget = widget_layer_get(layer);
+    if (widget->cache_valid && fb_cache_copy(ctx, layer, widget->cache, false)) return;
+
+    calendar_draw(ctx, layer, widget, layer_get_bounds(layer));
+    if (widget->cache) {
+        widget->cache_valid = fb_cache_copy(ctx, layer, widget->cache, true);
+    }
+}
+
+// widget -------------------------------------------------------------------------
+
+CalendarWidget *widget_calendar_create(GRect frame, GFont font, GFont bold_font) {
+    CalendarWidget *widget = widget_layer_create("calendar", frame, sizeof(CalendarWidget));
+    if (!widget) return NULL;
+
+    layer_set_update_proc(widget->layer, RENDER_TIMED(widget_calendar_update));
+
+    widget->font = font;
+    widget->bold_font = bold_font;
+    widget->day = 1;
+
+    // Without the cache the strip is simply laid out on every redraw.
+    widget->cache = heap_track_sdk("calendar", fb_cache_create(frame.size));
+
+    return widget;
+}
+
+void widget_calendar_set_date(CalendarWidget *widget, const struct tm *date) {
+    if (!widget) return;
+    if (widget->year == date->tm_year && widget->month == date->tm_mon && widget->day == date->tm_mday) return;
+
+    widget->year = date->tm_year;
+    widget->month = date->tm_mon;
+    widget->day = date->tm_mday;
+    widget->weekday = date->tm_wday;
+    widget->cache_valid = false;
+    layer_mark_dirty(widget->layer);
+}
+
+void widget_calendar_destroy(CalendarWidget *widget) {
+    if (!widget) return;
+    heap_track_sdk_release(widget->cache);
+    gbitmap_destroy(widget->cache);
+    widget_layer_destroy(widget);
+}
+
+// widget class -------------------------------------------------------------------
+
+static void calendar_destroy(void *widget) {
+    widget_calendar_destroy(widget);
+}
+
+static void calendar_on_tick(void *widget, struct tm *tick_time, TimeUnits units_changed) {
+    widget_calendar_set_date(widget, tick_time);
+}
+
+const WidgetClass CALENDAR_WIDGET_CLASS = {
+    .name = "calendar",
+    .destroy = calendar_destroy,
+    .on_tick = calendar_on_tick,
+    .tick_units = DAY_UNIT,
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <pebble.h>
+#include "widget.h"
+
+// Two-week strip: weekday letters over this week's dates, Monday first, with
+// today highlighted, and next week's dates below.
+//
+// The strip only changes with the date, so after a date change it is laid
+// out once and the result is copied out of the framebuffer into a cached
+// bitmap; every other redraw copies the bitmap back in.
+typedef struct {
+    Layer *layer;
+    GFont font;
+    GFont bold_font;
+
+    // the date shown, as in struct tm
+    int year;
+    int month;
+    int day;
+    int weekday;
+
+    GBitmap *cache; // the drawn strip in the framebuffer's format
+    bool cache_valid;
+} CalendarWidget;
+
+CalendarWidget *widget_calendar_create(GRect frame, GFont font, GFont bold_font);
+void widget_calendar_destroy(CalendarWidget *widget);
+void widget_calendar_update(Layer *layer, GContext *ctx);
+
+// Only redraws when the day actually changed.
+void widget_calendar_set_date(CalendarWidget *widget, const struct tm *date);
+
+// `year` counts from 1900 and `month` from 0, like struct tm.
+int calendar_days_in_month(int year, int month);
+
+// Ticks on DAY_UNIT with widget_calendar_set_date().
+extern const WidgetClass CALENDAR_WIDGET_CLASS;
@@ -0,0 +1,57 @@
+#include <pebble.h>
+#include <string.h>
+#include "fb_cache.h"
+
+GBitmap *fb_cache_create(GSize size) {
+    return gbitmap_create_blank(size, PBL_IF_BW_ELSE(GBitmapFormat1Bit, GBitmapFormat8Bit));
+}
+
+bool fb_cache_copy(GContext *ctx, Layer *layer, GBitmap *cache, bool to_cache) {
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return false;
+
+    const GRect fb_bounds = gbitmap_get_bounds(fb);
+    const bool one_bit = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+    const GRect bounds = layer_get_bounds(layer);
+    const GPoint origin = layer_convert_point_to_screen(layer, bounds.origin);
+    const uint16_t stride = gbitmap_get_bytes_per_row(cache);
+    uint8_t *cache_data = gbitmap_get_data(cache);
+
+    for (int y = 0; y < bounds.size.h; y++) {
+        int dy = origin.y + y;
+        if (dy < fb_bounds.origin.y || dy >= fb_bounds.origin.y + fb_bounds.size.h) continue;
+
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, dy);
+        int x0 = origin.x > info.min_x ? origin.x : info.min_x;
+        int x1 = origin.x + bounds.size.w - 1 < info.max_x ? origin.x + bounds.size.w - 1 : info.max_x;
+        if (x0 > x1) continue;
+
+        uint8_t *row = cache_data + y * stride;
+        if (!one_bit) {
+            uint8_t *screen = info.data + x0;
+            uint8_t *cached = row + (x0 - origin.x);
+            memcpy(to_cache ? cached : screen, to_cache ? screen : cached, x1 - x0 + 1);
+            continue;
+        }
+
+        // 1-bit: whole bytes when the strip starts on a byte, then bit by bit.
+        int x = x0;
+        if (!((x0 - origin.x) & 7) && !(x0 & 7)) {
+            int bytes = (x1 - x0 + 1) >> 3;
+            uint8_t *screen = info.data + (x0 >> 3);
+            uint8_t *cached = row + ((x0 - origin.x) >> 3);
+            memcpy(to_cache ? cached : screen, to_cache ? screen : cached, bytes);
+            x += bytes << 3;
+        }
+        for (; x <= x1; x++) {
+            int cx = x - origin.x;
+            uint8_t *dst = to_cache ? &row[cx >> 3] : &info.data[x >> 3];
+            uint8_t dst_bit = 1 << ((to_cache ? cx : x) & 7);
+            bool set = to_cache ? (info.data[x >> 3] >> (x & 7)) & 1 : (row[cx >> 3] >> (cx & 7)) & 1;
+            *dst = set ? (*dst | dst_bit) : (*dst & ~dst_bit);
+        }
+    }
+
+    graphics_release_frame_buffer(ctx, fb);
+    return true;
+}
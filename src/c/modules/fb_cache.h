@@ -0,0 +1,14 @@
+#pragma once
+#include <pebble.h>
+
+// Offscreen copies of what a layer drew, for widgets whose content changes
+// far less often than the screen is redrawn. The copy holds the layer's whole
+// rect, background included, so it is only valid while nothing drawn under
+// the layer changes.
+
+// A blank bitmap of `size` in the framebuffer's format, or NULL.
+GBitmap *fb_cache_create(GSize size);
+
+// Copies the layer's part of the screen between the framebuffer and `cache`,
+// in whichever direction. Returns false if the framebuffer is busy.
+bool fb_cache_copy(GContext *ctx, Layer *layer, GBitmap *cache, bool to_cache);
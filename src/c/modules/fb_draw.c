@@ -0,0 +1,185 @@
+#include <pebble.h>
+#include <string.h>
+#include "fb_draw.h"
+
+bool fb_draw_begin(FbDraw *draw, GContext *ctx, Layer *layer) {
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return false;
+
+    const GRect bounds = layer_get_bounds(layer);
+    draw->ctx = ctx;
+    draw->fb = fb;
+    draw->origin = layer_convert_point_to_screen(layer, GPointZero);
+    draw->clip = GRect(draw->origin.x, draw->origin.y, bounds.size.w, bounds.size.h);
+    grect_clip(&draw->clip, &(GRect){.size = gbitmap_get_bounds(fb).size});
+    draw->one_bit = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+    return true;
+}
+
+void fb_draw_end(FbDraw *draw) {
+    graphics_release_frame_buffer(draw->ctx, draw->fb);
+    draw->fb = NULL;
+}
+
+// spans ---------------------------------------------------------------------------
+
+// 1-bit screens show a color as white when it is at least as bright as light gray.
+static bool fb_draw_is_white(GColor color) {
+    return color.r + color.g + color.b >= 5;
+}
+
+// Pixels x0..x1-1 of an 8-bit row: bytes up to a word boundary, then words.
+static void span_8bit(uint8_t *row, int x0, int x1, uint8_t color) {
+    uint8_t *p = row + x0;
+    uint8_t *end = row + x1;
+    while (p < end && ((uintptr_t)p & 3)) *p++ = color;
+    const uint32_t word = color * 0x01010101u;
+    for (; p + 4 <= end; p += 4) *(uint32_t *)p = word;
+    while (p < end) *p++ = color;
+}
+
+// Pixels x0..x1-1 of a 1-bit row, least significant bit first: masked end
+// bytes around whole bytes, whole words where the row allows.
+static void span_1bit(uint8_t *row, int x0, int x1, bool white) {
+    const uint8_t fill = white ? 0xff : 0x00;
+    int first = x0 >> 3;
+    const int last = (x1 - 1) >> 3;
+    if (first == last) {
+        const uint8_t mask = (uint8_t)((0xff << (x0 & 7)) & (0xff >> (7 - ((x1 - 1) & 7))));
+        row[first] = white ? row[first] | mask : row[first] & ~mask;
+        return;
+    }
+    if (x0 & 7) {
+        const uint8_t mask = (uint8_t)(0xff << (x0 & 7));
+        row[first] = white ? row[first] | mask : row[first] & ~mask;
+        first++;
+    }
+    int full_end = (x1 & 7) ? last : last + 1;
+    uint8_t *p = row + first;
+    uint8_t *end = row + full_end;
+    while (p < end && ((uintptr_t)p & 3)) *p++ = fill;
+    for (; p + 4 <= end; p += 4) *(uint32_t *)p = white ? 0xffffffffu : 0;
+    while (p < end) *p++ = fill;
+    if (x1 & 7) {
+        const uint8_t mask = (uint8_t)(0xff >> (8 - (x1 & 7)));
+        row[last] = white ? row[last] | mask : row[last] & ~mask;
+    }
+}
+
+// Inverts pixels x0..x1-1 of a row, a word at a time in between: `bits` is
+// the XOR pattern of one byte, and `pixels_per_byte` 8 for 1-bit rows.
+static void span_invert(uint8_t *row, int x0, int x1, uint8_t bits, int pixels_per_byte) {
+    if (pixels_per_byte == 8) {
+        const int first = x0 >> 3;
+        const int last = (x1 - 1) >> 3;
+        const uint8_t head = (uint8_t)(0xff << (x0 & 7));
+        const uint8_t tail = (uint8_t)(0xff >> (7 - ((x1 - 1) & 7)));
+        if (first == last) {
+            row[first] ^= head & tail;
+            return;
+        }
+        row[first] ^= head;
+        row[last] ^= tail;
+        x0 = first + 1;
+        x1 = last;
+    }
+    uint8_t *p = row + x0;
+    uint8_t *end = row + x1;
+    while (p < end && ((uintptr_t)p & 3)) *p++ ^= bits;
+    const uint32_t word = bits * 0x01010101u;
+    for (; p + 4 <= end; p += 4) *(uint32_t *)p ^= word;
+    while (p < end) *p++ ^= bits;
+}
+
+// Pixels a rounded corner leaves out of the row `dy` rows from its edge: the
+// row's center is inside the circle up to round(sqrt(r^2 - (r - dy - 0.5)^2)).
+static int corner_inset(int radius, int dy) {
+    if (dy >= radius) return 0;
+    const int d = 2 * (radius - dy) - 1; // twice the distance from the center
+    const int limit = 4 * radius * radius - d * d;
+    int reach = 0;
+    while ((2 * reach + 1) * (2 * reach + 1) <= limit) reach++;
+    return radius - reach;
+}
+
+void fb_draw_pixel(FbDraw *draw, GPoint point, GColor color) {
+    const int x = draw->origin.x + point.x;
+    const int y = draw->origin.y + point.y;
+    if (!color.a || x < draw->clip.origin.x || x >= draw->clip.origin.x + draw->clip.size.w ||
+        y < draw->clip.origin.y || y >= draw->clip.origin.y + draw->clip.size.h) {
+        return;
+    }
+
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(draw->fb, y);
+    if (x < info.min_x || x > info.max_x) return;
+    if (!draw->one_bit) {
+        info.data[x] = color.argb;
+    } else if (fb_draw_is_white(color)) {
+        info.data[x >> 3] |= 1 << (x & 7);
+    } else {
+        info.data[x >> 3] &= ~(1 << (x & 7));
+    }
+}
+
+void fb_draw_fill_rect(FbDraw *draw, GRect rect, uint16_t corner_radius, GCornerMask corner_mask, GColor color) {
+    if (!color.a || rect.size.w <= 0 || rect.size.h <= 0) return;
+    int radius = corner_mask ? corner_radius : 0;
+    if (radius > rect.size.w / 2) radius = rect.size.w / 2;
+    if (radius > rect.size.h / 2) radius = rect.size.h / 2;
+
+    const bool white = fb_draw_is_white(color);
+    const int x = draw->origin.x + rect.origin.x;
+    const int y = draw->origin.y + rect.origin.y;
+    const int clip_x0 = draw->clip.origin.x;
+    const int clip_x1 = draw->clip.origin.x + draw->clip.size.w;
+    int row = 0;
+    int rows = rect.size.h;
+    if (y < draw->clip.origin.y) row = draw->clip.origin.y - y;
+    if (y + rows > draw->clip.origin.y + draw->clip.size.h) rows = draw->clip.origin.y + draw->clip.size.h - y;
+
+    for (; row < rows; row++) {
+        int left = 0, right = 0;
+        if (radius) {
+            const int top_inset = corner_inset(radius, row);
+            const int bottom_inset = corner_inset(radius, rect.size.h - 1 - row);
+            if (corner_mask & GCornerTopLeft) left = top_inset;
+            if (corner_mask & GCornerTopRight) right = top_inset;
+            if ((corner_mask & GCornerBottomLeft) && bottom_inset > left) left = bottom_inset;
+            if ((corner_mask & GCornerBottomRight) && bottom_inset > right) right = bottom_inset;
+        }
+
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(draw->fb, y + row);
+        int x0 = x + left;
+        int x1 = x + rect.size.w - right;
+        if (x0 < clip_x0) x0 = clip_x0;
+        if (x0 < info.min_x) x0 = info.min_x;
+        if (x1 > clip_x1) x1 = clip_x1;
+        if (x1 > info.max_x + 1) x1 = info.max_x + 1;
+        if (x0 >= x1) continue;
+
+        if (draw->one_bit) {
+            span_1bit(info.data, x0, x1, white);
+        } else {
+            span_8bit(info.data, x0, x1, color.argb);
+        }
+    }
+}
+
+void fb_draw_invert_rect(FbDraw *draw, GRect rect) {
+    GRect screen = GRect(draw->origin.x + rect.origin.x, draw->origin.y + rect.origin.y, rect.size.w, rect.size.h);
+    grect_clip(&screen, &draw->clip);
+
+    for (int y = screen.origin.y; y < screen.origin.y + screen.size.h; y++) {
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(draw->fb, y);
+        int x0 = screen.origin.x > info.min_x ? screen.origin.x : info.min_x;
+        int x1 = screen.origin.x + screen.size.w < info.max_x + 1 ? screen.origin.x + screen.size.w : info.max_x + 1;
+        if (x0 >= x1) continue;
+
+        if (draw->one_bit) {
+            span_invert(info.data, x0, x1, 0xff, 8);
+        } else {
+            // the color bits; alpha stays
+            span_invert(info.data, x0, x1, 0x3f, 1);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <pebble.h>
+
+// Rectangle fills written straight into the framebuffer's rows, for widgets
+// drawn from axis-aligned boxes. Each fill is a run of row spans: whole
+// bytes (8-bit) or whole 32-bit words of pixels (1-bit and long 8-bit runs)
+// with masked ends, instead of the SDK's general fill path.
+//
+// A widget opts in by drawing between fb_draw_begin() and fb_draw_end(), and
+// falls back to graphics_fill_rect() when begin fails. The framebuffer is
+// held in between, so no graphics_* call may be made until fb_draw_end().
+// Fills are clipped to the layer and, on round screens, to the visible rows.
+typedef struct {
+    GContext *ctx;
+    GBitmap *fb;
+    GPoint origin; // screen position of the layer's drawing origin
+    GRect clip;    // screen coordinates
+    bool one_bit;
+} FbDraw;
+
+// Takes the framebuffer for drawing into `layer`. False if it is busy.
+bool fb_draw_begin(FbDraw *draw, GContext *ctx, Layer *layer);
+void fb_draw_end(FbDraw *draw);
+
+// Like graphics_draw_pixel() with `color`, in the layer's coordinates.
+void fb_draw_pixel(FbDraw *draw, GPoint point, GColor color);
+
+// Like graphics_fill_rect() with `color`, in the layer's coordinates. Corners
+// are rounded the same way.
+void fb_draw_fill_rect(FbDraw *draw, GRect rect, uint16_t corner_radius, GCornerMask corner_mask, GColor color);
+
+// Inverts what is drawn in `rect`: 1-bit pixels flip, 8-bit ones take the
+// complement of their color.
+void fb_draw_invert_rect(FbDraw *draw, GRect rect);
@@ -0,0 +1,52 @@
+#include <pebble.h>
+#include "font_manager.h"
+#include "heap_track.h"
+
+typedef struct {
+    uint32_t resource_id;
+    int refs;
+    GFont font;
+} ManagedFont;
+
+static ManagedFont s_fonts[FONT_MANAGER_MAX_FONTS];
+
+static ManagedFont *font_find(uint32_t resource_id) {
+    for (int i = 0; i < FONT_MANAGER_MAX_FONTS; i++) {
+        if (s_fonts[i].refs && s_fonts[i].resource_id == resource_id) return &s_fonts[i];
+    }
+    return NULL;
+}
+
+void font_manager_acquire(uint32_t resource_id) {
+    ManagedFont *managed = font_find(resource_id);
+    for (int i = 0; !managed && i < FONT_MANAGER_MAX_FONTS; i++) {
+        if (!s_fonts[i].refs) {
+            managed = &s_fonts[i];
+            *managed = (ManagedFont){.resource_id = resource_id};
+        }
+    }
+    if (managed) {
+        managed->refs++;
+    } else {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "font manager full, font %lu not held", (unsigned long)resource_id);
+    }
+}
+
+void font_manager_release(uint32_t resource_id) {
+    ManagedFont *managed = font_find(resource_id);
+    if (!managed || --managed->refs) return;
+    if (managed->font) {
+        heap_track_sdk_release(managed->font);
+        fonts_unload_custom_font(managed->font);
+        managed->font = NULL;
+    }
+}
+
+GFont font_manager_get(uint32_t resource_id) {
+    ManagedFont *managed = font_find(resource_id);
+    if (!managed) return NULL;
+    if (!managed->font) {
+        managed->font = heap_track_sdk("font", fonts_load_custom_font(resource_get_handle(resource_id)));
+    }
+    return managed->font;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <pebble.h>
+
+// Custom fonts shared by resource id. Holding a reference doesn't load the
+// font: font_manager_get() loads it on first use, and it is unloaded when the
+// last reference goes. Widgets that only need a font to build a glyph atlas
+// can drop their reference once it is built, so the font isn't resident at
+// all while the face runs.
+#define FONT_MANAGER_MAX_FONTS 4
+
+void font_manager_acquire(uint32_t resource_id);
+void font_manager_release(uint32_t resource_id);
+
+// The font, loaded if needed; NULL if it isn't held or fails to load.
+GFont font_manager_get(uint32_t resource_id);
@@ -0,0 +1,285 @@
+#include <pebble.h>
+#include <string.h>
+#include "glyph_text.h"
+#include "font_manager.h"
+#include "widget_alloc.h"
+#include "render_timing.h"
+#include "../generated/glyph_atlas.h"
+
+RENDER_TIMING_WRAP(widget_glyph_text_update)
+
+#define GLYPH_TEXT_MAX_LENGTH 24
+
+// atlas resource layout, see tools/glyph_atlas.py
+#define ATLAS_VERSION 1
+#define ATLAS_HEADER_SIZE 4
+#define ATLAS_RECORD_SIZE 6
+
+typedef struct {
+    char c;
+    uint8_t advance;
+    int16_t x; // ink rect, relative to the pen position and the top of the line
+    int16_t y;
+    uint8_t w;
+    uint8_t h;
+    uint16_t offset; // first row in `bits`; rows are (w + 7) / 8 bytes, LSB first
+} Glyph;
+
+struct GlyphAtlas {
+    GlyphAtlas *next;
+    int refs;
+    uint32_t font_id;
+    const char *chars;
+
+    int count;
+    Glyph *glyphs;
+    uint8_t *bits;
+};
+
+static GlyphAtlas *s_atlases;
+static const uint32_t s_atlas_fonts[][2] = GLYPH_ATLAS_FONTS;
+
+// atlas --------------------------------------------------------------------------
+
+static const Glyph *atlas_glyph(const GlyphAtlas *atlas, char c) {
+    for (int i = 0; i < atlas->count; i++) {
+        if (atlas->glyphs[i].c == c) return &atlas->glyphs[i];
+    }
+    return NULL;
+}
+
+static int chars_distinct(const char *chars) {
+    int count = 0;
+    for (const char *c = chars; *c; c++) {
+        if (!memchr(chars, *c, c - chars)) count++;
+    }
+    return count;
+}
+
+// Takes the glyphs of `chars` the font's atlas resource has: their records
+// first, each noting where its rows are in the resource, then the rows.
+static bool atlas_load(GlyphAtlas *atlas) {
+    ResHandle handle = NULL;
+    for (size_t i = 0; i < sizeof(s_atlas_fonts) / sizeof(s_atlas_fonts[0]); i++) {
+        if (s_atlas_fonts[i][0] == atlas->font_id) handle = resource_get_handle(s_atlas_fonts[i][1]);
+    }
+    uint8_t header[ATLAS_HEADER_SIZE];
+    if (!handle || resource_load_byte_range(handle, 0, header, sizeof(header)) != sizeof(header) ||
+        memcmp(header, "GA", 2) || header[2] != ATLAS_VERSION) {
+        APP_LOG(APP_LOG_LEVEL_ERROR, "GlyphTextWidget: no glyph atlas for font %d", (int)atlas->font_id);
+        return false;
+    }
+    atlas->glyphs = widget_alloc("glyph_text", chars_distinct(atlas->chars) * sizeof(Glyph));
+    if (!atlas->glyphs) return false;
+
+    size_t bits_size = 0;
+    uint32_t rows = ATLAS_HEADER_SIZE + header[3] * ATLAS_RECORD_SIZE;
+    for (int i = 0; i < header[3]; i++) {
+        uint8_t record[ATLAS_RECORD_SIZE];
+        if (resource_load_byte_range(handle, ATLAS_HEADER_SIZE + i * ATLAS_RECORD_SIZE, record, sizeof(record)) !=
+            sizeof(record)) {
+            return false;
+        }
+        const size_t size = (record[4] + 7) / 8 * record[5];
+        if (record[0] && strchr(atlas->chars, record[0]) && !atlas_glyph(atlas, record[0])) {
+            atlas->glyphs[atlas->count++] = (Glyph){
+                .c = record[0], .advance = record[1], .x = (int8_t)record[2], .y = (int8_t)record[3],
+                .w = record[4], .h = record[5], .offset = rows,
+            };
+            bits_size += size;
+        }
+        rows += size;
+    }
+
+    atlas->bits = widget_alloc("glyph_text", bits_size ? bits_size : 1);
+    if (!atlas->bits) return false;
+    for (int i = 0, offset = 0; i < atlas->count; i++) {
+        Glyph *glyph = &atlas->glyphs[i];
+        const size_t size = (glyph->w + 7) / 8 * glyph->h;
+        if (size && resource_load_byte_range(handle, glyph->offset, atlas->bits + offset, size) != size) return false;
+        glyph->offset = offset;
+        offset += size;
+    }
+    return true;
+}
+
+static void atlas_release(GlyphAtlas *atlas) {
+    if (!atlas || --atlas->refs) return;
+    for (GlyphAtlas **link = &s_atlases; *link; link = &(*link)->next) {
+        if (*link == atlas) {
+            *link = atlas->next;
+            break;
+        }
+    }
+    widget_free(atlas->bits);
+    widget_free(atlas->glyphs);
+    widget_free(atlas);
+}
+
+// Widgets with the same font and character set share an atlas, loaded with
+// the first of them. NULL if there is no atlas for the font.
+static GlyphAtlas *atlas_acquire(uint32_t font_id, const char *chars) {
+    for (GlyphAtlas *atlas = s_atlases; atlas; atlas = atlas->next) {
+        if (atlas->font_id == font_id && !strcmp(atlas->chars, chars)) {
+            atlas->refs++;
+            return atlas;
+        }
+    }
+
+    GlyphAtlas *atlas = widget_alloc("glyph_text", sizeof(GlyphAtlas));
+    if (!atlas) return NULL;
+    memset(atlas, 0, sizeof(GlyphAtlas));
+    atlas->refs = 1;
+    atlas->font_id = font_id;
+    atlas->chars = chars;
+    atlas->next = s_atlases;
+    s_atlases = atlas;
+    if (!atlas_load(atlas)) {
+        atlas_release(atlas);
+        return NULL;
+    }
+    return atlas;
+}
+
+// drawing ------------------------------------------------------------------------
+
+static void glyph_blit(const GlyphAtlas *atlas, GBitmap *fb, GRect clip, int pen_x, int top, const Glyph *glyph,
+                       GColor color) {
+    const bool one_bit = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+    const bool white = !gcolor_equal(color, GColorBlack);
+    const int row_bytes = (glyph->w + 7) / 8;
+    const uint8_t *src = atlas->bits + glyph->offset;
+    const int x0 = pen_x + glyph->x;
+
+    for (int y = 0; y < glyph->h; y++, src += row_bytes) {
+        int sy = top + glyph->y + y;
+        if (sy < clip.origin.y || sy >= clip.origin.y + clip.size.h) continue;
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, sy);
+        int min_x = clip.origin.x > info.min_x ? clip.origin.x : info.min_x;
+        int max_x = clip.origin.x + clip.size.w - 1 < info.max_x ? clip.origin.x + clip.size.w - 1 : info.max_x;
+
+        for (int x = 0; x < glyph->w; x++) {
+            int sx = x0 + x;
+            if (sx < min_x || sx > max_x || !((src[x >> 3] >> (x & 7)) & 1)) continue;
+            if (!one_bit) {
+                info.data[sx] = color.argb;
+            } else if (white) {
+                info.data[sx >> 3] |= 1 << (sx & 7);
+            } else {
+                info.data[sx >> 3] &= ~(1 << (sx & 7));
+            }
+        }
+    }
+}
+
+// Lays the text out from the glyph advances, like graphics_draw_text on one
+// line. False if a character has no glyph or the framebuffer is busy.
+static bool atlas_draw(const GlyphAtlas *atlas, GContext *ctx, Layer *layer, const char *text,
+                       GTextAlignment alignment, GColor color) {
+    const Glyph *glyphs[GLYPH_TEXT_MAX_LENGTH];
+    int length = 0, width = 0;
+    for (const char *c = text; *c; c++) {
+        const Glyph *glyph = length < GLYPH_TEXT_MAX_LENGTH ? atlas_glyph(atlas, *c) : NULL;
+        if (!glyph) return false;
+        glyphs[length++] = glyph;
+        width += glyph->advance;
+    }
+
+    const GRect bounds = layer_get_bounds(layer);
+    int pen = 0;
+    if (alignment == GTextAlignmentCenter) {
+        pen = (bounds.size.w - width) / 2;
+    } else if (alignment == GTextAlignmentRight) {
+        pen = bounds.size.w - width;
+    }
+
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return false;
+    // glyphs stay inside the layer and the screen
+    const GPoint origin = layer_convert_point_to_screen(layer, bounds.origin);
+    const GRect fb_bounds = gbitmap_get_bounds(fb);
+    int x0 = origin.x > fb_bounds.origin.x ? origin.x : fb_bounds.origin.x;
+    int y0 = origin.y > fb_bounds.origin.y ? origin.y : fb_bounds.origin.y;
+    int x1 = origin.x + bounds.size.w < fb_bounds.origin.x + fb_bounds.size.w ? origin.x + bounds.size.w
+                                                                               : fb_bounds.origin.x + fb_bounds.size.w;
+    int y1 = origin.y + bounds.size.h < fb_bounds.origin.y + fb_bounds.size.h ? origin.y + bounds.size.h
+                                                                               : fb_bounds.origin.y + fb_bounds.size.h;
+    const GRect clip = GRect(x0, y0, x1 - x0, y1 - y0);
+    for (int i = 0; i < length; i++) {
+        glyph_blit(atlas, fb, clip, origin.x + pen, origin.y, glyphs[i], color);
+        pen += glyphs[i]->advance;
+    }
+    graphics_release_frame_buffer(ctx, fb);
+    return true;
+}
+
+void widget_glyph_text_update(Layer *layer, GContext *ctx) {
+    GlyphTextWidget *widget = widget_layer_get(layer);
+    const char *text = widget->text ? widget->text : "";
+    widget->drawn_valid = strlen(text) <= GLYPH_TEXT_DRAWN_MAX;
+    if (widget->drawn_valid) strcpy(widget->drawn, text);
+    if (!text[0]) return;
+
+    if (widget->atlas && atlas_draw(widget->atlas, ctx, layer, widget->text, widget->alignment, widget->color)) {
+        return;
+    }
+
+    // without the atlas the font is held from the first such draw until the widget goes
+    if (!widget->font_held) {
+        font_manager_acquire(widget->font_id);
+        widget->font_held = true;
+    }
+    GFont font = font_manager_get(widget->font_id);
+    if (font) {
+        graphics_context_set_text_color(ctx, widget->color);
+        graphics_draw_text(ctx, widget->text, font, layer_get_bounds(layer), GTextOverflowModeWordWrap,
+                           widget->alignment, NULL);
+    }
+}
+
+// widget -------------------------------------------------------------------------
+
+GlyphTextWidget *widget_glyph_text_create(GRect frame, uint32_t font_id, GColor color, GTextAlignment alignment,
+                                          const char *chars) {
+    GlyphTextWidget *widget = widget_layer_create("glyph_text", frame, sizeof(GlyphTextWidget));
+    if (!widget) return NULL;
+
+    layer_set_update_proc(widget->layer, RENDER_TIMED(widget_glyph_text_update));
+
+    widget->font_id = font_id;
+    widget->color = color;
+    widget->alignment = alignment;
+    // Without an atlas the text is simply drawn with the font engine.
+    widget->atlas = atlas_acquire(font_id, chars);
+    if (!widget->atlas) {
+        font_manager_acquire(font_id);
+        widget->font_held = true;
+    }
+
+    return widget;
+}
+
+void widget_glyph_text_set(GlyphTextWidget *widget, const char *text) {
+    if (!widget) return;
+    widget->text = text;
+    if (widget->drawn_valid && !strcmp(text ? text : "", widget->drawn)) return;
+    layer_mark_dirty(widget->layer);
+}
+
+void widget_glyph_text_destroy(GlyphTextWidget *widget) {
+    if (!widget) return;
+    atlas_release(widget->atlas);
+    if (widget->font_held) font_manager_release(widget->font_id);
+    widget_layer_destroy(widget);
+}
+
+// widget class -------------------------------------------------------------------
+
+static void glyph_text_destroy(void *widget) {
+    widget_glyph_text_destroy(widget);
+}
+
+const WidgetClass GLYPH_TEXT_WIDGET_CLASS = {
+    .name = "glyph_text",
+    .destroy = glyph_text_destroy,
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <pebble.h>
+#include "widget.h"
+
+// A one-line label for short strings from a small character set, such as
+// "00"-"59", battery percents and dates, drawn without the font engine.
+//
+// The glyphs come from the font's glyph atlas resource, rendered from the TTF
+// at build time by tools/glyph_atlas.py. Creating the widget loads those of
+// its character set, and strings are laid out from the glyph advances and
+// blitted straight into the framebuffer in the widget's color, clipped to the
+// layer. Widgets with the same font and character set share one atlas, which
+// is freed with the last of them. The font is a custom font resource.
+//
+// Strings with a character outside the set, or any string when the font has
+// no atlas, are drawn with graphics_draw_text like a TextLayer; the widget
+// then keeps its own hold on the font until it is destroyed.
+#define GLYPH_TEXT_DIGITS "0123456789"
+
+// Longest text setting the same string again is recognized for.
+#define GLYPH_TEXT_DRAWN_MAX 15
+
+typedef struct GlyphAtlas GlyphAtlas;
+
+typedef struct {
+    Layer *layer;
+    uint32_t font_id; // custom font resource
+    GColor color;
+    GTextAlignment alignment;
+    const char *text; // not copied, like text_layer_set_text()
+    char drawn[GLYPH_TEXT_DRAWN_MAX + 1]; // `text` at the last redraw, if it fit
+    bool drawn_valid;
+    GlyphAtlas *atlas;
+    bool font_held; // drawn with the font engine, so its font stays loaded
+} GlyphTextWidget;
+
+GlyphTextWidget *widget_glyph_text_create(GRect frame, uint32_t font_id, GColor color, GTextAlignment alignment,
+                                          const char *chars);
+void widget_glyph_text_destroy(GlyphTextWidget *widget);
+void widget_glyph_text_update(Layer *layer, GContext *ctx);
+
+// Redraws only if `text` differs from what was last drawn.
+void widget_glyph_text_set(GlyphTextWidget *widget, const char *text);
+
+// What a label shows is up to the face, so the class has no tick handler.
+extern const WidgetClass GLYPH_TEXT_WIDGET_CLASS;
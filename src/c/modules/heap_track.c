@@ -0,0 +1,126 @@
+#include <pebble.h>
+#include <string.h>
+#include "heap_track.h"
+
+#if defined(WIDGET_HEAP_TRACKING)
+
+typedef struct {
+    const void *ptr;
+    size_t bytes;
+    const char *tag;
+    const char *site;
+} TrackedBlock;
+
+static TrackedBlock s_blocks[HEAP_TRACK_MAX_BLOCKS];
+static size_t s_mark;
+static size_t s_used_before_load;
+static size_t s_used_after_first_unload;
+static int s_cycles;
+
+void *heap_track_add(const char *tag, const char *site, void *ptr, size_t bytes) {
+    if (!ptr) return NULL;
+    for (int i = 0; i < HEAP_TRACK_MAX_BLOCKS; i++) {
+        if (!s_blocks[i].ptr) {
+            s_blocks[i] = (TrackedBlock){ptr, bytes, tag, site};
+            return ptr;
+        }
+    }
+    APP_LOG(APP_LOG_LEVEL_WARNING, "heap_track: table full, %s not tracked", site);
+    return ptr;
+}
+
+void heap_track_mark(void) {
+    s_mark = heap_bytes_used();
+}
+
+void *heap_track_add_sdk(const char *tag, const char *site, void *ptr) {
+    size_t used = heap_bytes_used();
+    return heap_track_add(tag, site, ptr, used > s_mark ? used - s_mark : 0);
+}
+
+void heap_track_remove(const void *ptr) {
+    if (!ptr) return;
+    for (int i = 0; i < HEAP_TRACK_MAX_BLOCKS; i++) {
+        if (s_blocks[i].ptr == ptr) {
+            s_blocks[i].ptr = NULL;
+            return;
+        }
+    }
+}
+
+// True if an earlier live block has the same tag (and site, if `by_site`),
+// so each group is reported once, at its first block.
+static bool seen_before(int index, bool by_site) {
+    for (int i = 0; i < index; i++) {
+        if (s_blocks[i].ptr && !strcmp(s_blocks[i].tag, s_blocks[index].tag) &&
+            (!by_site || !strcmp(s_blocks[i].site, s_blocks[index].site))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void heap_track_report(const char *label) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "heap %s: %u B used, %u B free", label, (unsigned)heap_bytes_used(),
+            (unsigned)heap_bytes_free());
+
+    for (int t = 0; t < HEAP_TRACK_MAX_BLOCKS; t++) {
+        if (!s_blocks[t].ptr || seen_before(t, false)) continue;
+        int blocks = 0;
+        size_t bytes = 0;
+        for (int i = t; i < HEAP_TRACK_MAX_BLOCKS; i++) {
+            if (s_blocks[i].ptr && !strcmp(s_blocks[i].tag, s_blocks[t].tag)) {
+                blocks++;
+                bytes += s_blocks[i].bytes;
+            }
+        }
+        APP_LOG(APP_LOG_LEVEL_INFO, "  %s: %d blocks, %u B", s_blocks[t].tag, blocks, (unsigned)bytes);
+
+        for (int s = t; s < HEAP_TRACK_MAX_BLOCKS; s++) {
+            if (!s_blocks[s].ptr || strcmp(s_blocks[s].tag, s_blocks[t].tag) || seen_before(s, true)) continue;
+            blocks = 0;
+            bytes = 0;
+            for (int i = s; i < HEAP_TRACK_MAX_BLOCKS; i++) {
+                if (s_blocks[i].ptr && !strcmp(s_blocks[i].tag, s_blocks[s].tag) &&
+                    !strcmp(s_blocks[i].site, s_blocks[s].site)) {
+                    blocks++;
+                    bytes += s_blocks[i].bytes;
+                }
+            }
+            APP_LOG(APP_LOG_LEVEL_INFO, "    %s: %d x, %u B", s_blocks[s].site, blocks, (unsigned)bytes);
+        }
+    }
+}
+
+void heap_track_load_begin(void) {
+    s_used_before_load = heap_bytes_used();
+    heap_track_report("before load");
+}
+
+void heap_track_load_end(void) {
+    heap_track_report("after load");
+    APP_LOG(APP_LOG_LEVEL_INFO, "heap: window load took %d B",
+            (int)(heap_bytes_used() - s_used_before_load));
+}
+
+void heap_track_unload_end(void) {
+    s_cycles++;
+    heap_track_report("after unload");
+
+    for (int i = 0; i < HEAP_TRACK_MAX_BLOCKS; i++) {
+        if (s_blocks[i].ptr) {
+            APP_LOG(APP_LOG_LEVEL_WARNING, "heap leak: %s, %u B from %s", s_blocks[i].tag,
+                    (unsigned)s_blocks[i].bytes, s_blocks[i].site);
+        }
+    }
+
+    size_t used = heap_bytes_used();
+    if (s_cycles == 1) {
+        s_used_after_first_unload = used;
+    } else if (s_cycles == HEAP_TRACK_LEAK_CYCLES && used > s_used_after_first_unload) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "heap leak: grew %u B over %d load/unload cycles",
+                (unsigned)(used - s_used_after_first_unload), HEAP_TRACK_LEAK_CYCLES - 1);
+    }
+}
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <pebble.h>
+
+// Opt-in heap accounting for the widgets, enabled by building with
+// WIDGET_HEAP_TRACKING (`pebble build -- --heap-tracking`, or
+// `make host HEAP_TRACKING=1`). Every tracked block is recorded with the
+// widget type and the call site that allocated it; SDK objects are charged the
+// change in heap_bytes_used() across their creation. Without the flag the
+// macros compile to the plain calls and the hooks to nothing.
+
+// Load/unload cycles the face runs at startup before leaks are judged.
+#define HEAP_TRACK_LEAK_CYCLES 3
+
+#if defined(WIDGET_HEAP_TRACKING)
+
+#define HEAP_TRACK_MAX_BLOCKS 48
+
+#define HEAP_TRACK_STR_(x) #x
+#define HEAP_TRACK_STR(x) HEAP_TRACK_STR_(x)
+#define HEAP_TRACK_SITE __FILE__ ":" HEAP_TRACK_STR(__LINE__)
+
+#define heap_track_malloc(tag, size) heap_track_add((tag), HEAP_TRACK_SITE, malloc(size), (size))
+#define heap_track_free(ptr) (heap_track_remove(ptr), free(ptr))
+#define heap_track_sdk(tag, call) (heap_track_mark(), heap_track_add_sdk((tag), HEAP_TRACK_SITE, (call)))
+#define heap_track_sdk_release(ptr) heap_track_remove(ptr)
+
+void *heap_track_add(const char *tag, const char *site, void *ptr, size_t bytes);
+void heap_track_mark(void);
+void *heap_track_add_sdk(const char *tag, const char *site, void *ptr);
+void heap_track_remove(const void *ptr);
+
+// Logs heap_bytes_used/free and the live tracked blocks by widget type and
+// call site.
+void heap_track_report(const char *label);
+
+// Window load/unload hooks. Every unload reports the tracked blocks still
+// alive as leaks; after HEAP_TRACK_LEAK_CYCLES unloads, heap growth since the
+// first unload is reported too, which also catches untracked allocations.
+void heap_track_load_begin(void);
+void heap_track_load_end(void);
+void heap_track_unload_end(void);
+
+#else
+
+#define heap_track_malloc(tag, size) malloc(size)
+#define heap_track_free(ptr) free(ptr)
+#define heap_track_sdk(tag, call) (call)
+#define heap_track_sdk_release(ptr) ((void)0)
+
+#define heap_track_report(label) ((void)0)
+#define heap_track_load_begin() ((void)0)
+#define heap_track_load_end() ((void)0)
+#define heap_track_unload_end() ((void)0)
+
+#endif
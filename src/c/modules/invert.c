@@ -0,0 +1,26 @@
+#include <pebble.h>
+#include "invert.h"
+#include "fb_draw.h"
+#include "heap_track.h"
+#include "render_timing.h"
+
+RENDER_TIMING_WRAP(invert_layer_update)
+
+void invert_layer_update(Layer *layer, GContext *ctx) {
+    FbDraw draw;
+    if (!fb_draw_begin(&draw, ctx, layer)) return;
+    fb_draw_invert_rect(&draw, layer_get_bounds(layer));
+    fb_draw_end(&draw);
+}
+
+Layer *invert_layer_create(GRect frame) {
+    Layer *layer = heap_track_sdk("invert", layer_create(frame));
+    if (layer) layer_set_update_proc(layer, RENDER_TIMED(invert_layer_update));
+    return layer;
+}
+
+void invert_layer_destroy(Layer *layer) {
+    if (!layer) return;
+    heap_track_sdk_release(layer);
+    layer_destroy(layer);
+}
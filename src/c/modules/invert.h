@@ -0,0 +1,8 @@
+#pragma once
+#include <pebble.h>
+
+// A layer that inverts everything drawn under it, e.g. to give a dark face a
+// light theme. Keep it the topmost layer of the window.
+Layer *invert_layer_create(GRect frame);
+void invert_layer_destroy(Layer *layer);
+void invert_layer_update(Layer *layer, GContext *ctx);
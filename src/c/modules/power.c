@@ -0,0 +1,89 @@
+#include <pebble.h>
+#include "power.h"
+
+static const PowerProfile PROFILES[] = {
+    [POWER_PROFILE_FULL] = {POWER_PROFILE_FULL, "full", SECOND_UNIT, true, HOUR_UNIT | DAY_UNIT},
+    [POWER_PROFILE_NORMAL] = {POWER_PROFILE_NORMAL, "normal", MINUTE_UNIT, true, DAY_UNIT},
+    [POWER_PROFILE_SAVER] = {POWER_PROFILE_SAVER, "saver", MINUTE_UNIT, false, DAY_UNIT},
+    [POWER_PROFILE_BURST] = {POWER_PROFILE_BURST, "burst", SECOND_UNIT, true, DAY_UNIT},
+};
+
+static const PowerProfile *s_profile = &PROFILES[POWER_PROFILE_NORMAL];
+static const PowerProfile *s_battery_profile = &PROFILES[POWER_PROFILE_NORMAL];
+static PowerProfileHandler s_handler;
+static AppTimer *s_burst_timer;
+static BatteryChargeState s_charge = {.charge_percent = 100};
+static bool s_always_saver;
+
+static void power_switch(const PowerProfile *next, const char *reason) {
+    if (next == s_profile) return;
+    APP_LOG(APP_LOG_LEVEL_INFO, "power: %s -> %s (%s)", s_profile->name, next->name, reason);
+    s_profile = next;
+    if (s_handler) s_handler(s_profile);
+}
+
+static PowerProfileId power_choose(PowerProfileId current, BatteryChargeState charge) {
+    if (s_always_saver) return POWER_PROFILE_SAVER;
+    if (charge.is_plugged || charge.is_charging) return POWER_PROFILE_FULL;
+    if (charge.charge_percent <= POWER_SAVER_PERCENT) return POWER_PROFILE_SAVER;
+    if (current == POWER_PROFILE_SAVER && charge.charge_percent <= POWER_SAVER_EXIT_PERCENT) {
+        return POWER_PROFILE_SAVER;
+    }
+    return POWER_PROFILE_NORMAL;
+}
+
+void power_governor_init(BatteryChargeState charge, PowerProfileHandler handler) {
+    s_handler = handler;
+    s_charge = charge;
+    s_battery_profile = &PROFILES[power_choose(POWER_PROFILE_NORMAL, charge)];
+    s_profile = s_battery_profile;
+    APP_LOG(APP_LOG_LEVEL_INFO, "power: %s at %d%%", s_profile->name, charge.charge_percent);
+}
+
+void power_governor_update(BatteryChargeState charge) {
+    s_charge = charge;
+    const PowerProfile *next = &PROFILES[power_choose(s_battery_profile->id, charge)];
+    if (next == s_battery_profile) return;
+
+    char reason[24];
+    snprintf(reason, sizeof(reason), "%d%%%s", charge.charge_percent, charge.is_plugged ? ", plugged" : "");
+    s_battery_profile = next;
+    if ((next->tick_unit == SECOND_UNIT || s_always_saver) && s_burst_timer) {
+        app_timer_cancel(s_burst_timer);
+        s_burst_timer = NULL;
+    }
+    // a running burst carries on and falls back to the new profile
+    if (!s_burst_timer) power_switch(next, reason);
+}
+
+const PowerProfile *power_governor_profile(void) {
+    return s_profile;
+}
+
+static void burst_end(void *data) {
+    s_burst_timer = NULL;
+    power_switch(s_battery_profile, "burst over");
+}
+
+void power_governor_burst(uint32_t ms) {
+    if (s_battery_profile->tick_unit == SECOND_UNIT || s_always_saver) return;
+
+    if (s_burst_timer && app_timer_reschedule(s_burst_timer, ms)) return;
+    s_burst_timer = app_timer_register(ms, burst_end, NULL);
+    if (s_burst_timer) power_switch(&PROFILES[POWER_PROFILE_BURST], "burst");
+}
+
+void power_governor_set_saver(bool always) {
+    if (always == s_always_saver) return;
+    s_always_saver = always;
+    power_governor_update(s_charge);
+}
+
+void power_governor_deinit(void) {
+    if (s_burst_timer) {
+        app_timer_cancel(s_burst_timer);
+        s_burst_timer = NULL;
+    }
+    s_profile = s_battery_profile;
+    s_handler = NULL;
+}
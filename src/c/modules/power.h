@@ -0,0 +1,58 @@
+#pragma once
+#include <pebble.h>
+
+// Battery-driven power profiles. The face feeds every BatteryChargeState to
+// power_governor_update(); the governor picks a profile from it and tells the
+// face through its handler whenever the profile changes.
+//
+//   full    on the charger: second ticks, rings sweep every second
+//   normal  minute ticks, rings move every minute
+//   saver   at POWER_SAVER_PERCENT or below: minute ticks, rings move only
+//           every POWER_SAVER_RING_MINUTES
+//
+// Saver is left again only above POWER_SAVER_EXIT_PERCENT, so a charge
+// level wobbling around the threshold doesn't flip the profile back and forth.
+//
+// On top of any of them a burst (e.g. on a wrist tap) switches to second
+// ticks for a while and then falls back, so the 1 Hz redraws are only paid
+// while someone is looking.
+#define POWER_SAVER_PERCENT 20
+#define POWER_SAVER_EXIT_PERCENT 30
+#define POWER_SAVER_RING_MINUTES 15
+#ifndef POWER_BURST_MS
+#define POWER_BURST_MS 30000
+#endif
+
+typedef enum {
+    POWER_PROFILE_FULL,
+    POWER_PROFILE_NORMAL,
+    POWER_PROFILE_SAVER,
+    POWER_PROFILE_BURST,
+} PowerProfileId;
+
+typedef struct {
+    PowerProfileId id;
+    const char *name;
+    TimeUnits tick_unit;      // finest tick the face subscribes to
+    bool animate;             // border and radial rings follow every tick
+    TimeUnits calendar_units; // ticks on which the calendar re-reads the date
+} PowerProfile;
+
+typedef void (*PowerProfileHandler)(const PowerProfile *profile);
+
+// Starts in the profile for `charge` without calling the handler; the face
+// applies power_governor_profile() while it loads.
+void power_governor_init(BatteryChargeState charge, PowerProfileHandler handler);
+void power_governor_update(BatteryChargeState charge);
+const PowerProfile *power_governor_profile(void);
+
+// Starts a burst of `ms`, or restarts the running one. Does nothing while
+// the battery profile already ticks every second.
+void power_governor_burst(uint32_t ms);
+
+// Keeps the saver profile whatever the battery, with no bursts, until turned
+// off again. May be called before power_governor_init().
+void power_governor_set_saver(bool always);
+
+// Ends any burst and drops the handler.
+void power_governor_deinit(void);
@@ -0,0 +1,11 @@
+#pragma once
+#include <pebble.h>
+
+// Widget progress is fixed-point: a fraction of PROGRESS_MAX, which is one
+// full turn in trig angle units. Radials can use it as an angle directly and
+// nothing on the draw path needs the soft-float runtime.
+#define PROGRESS_MAX TRIG_MAX_ANGLE
+
+// Progress of `num` out of `den`, e.g. PROGRESS_FRACTION(tm_min, 60).
+// Integer-only; exact for num up to 32767.
+#define PROGRESS_FRACTION(num, den) ((int32_t)(((int32_t)(num) * PROGRESS_MAX) / (den)))
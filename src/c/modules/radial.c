@@ -2,10 +2,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include "radial.h"
+#include "fb_cache.h"
+#include "render_timing.h"
+#include "transition.h"
+#include "widget_alloc.h"
 
-void widget_radial_update(Layer *layer, GContext *ctx) {
-    RadialWidget *widget = *(RadialWidget **)layer_get_data(layer);
-    GRect bounds = layer_get_bounds(layer);
+RENDER_TIMING_WRAP(widget_radial_update)
+
+// One step per pixel along the outer edge: finer steps don't move the ring.
+static int radial_steps(GRect bounds) {
+    int diameter = bounds.size.w < bounds.size.h ? bounds.size.w : bounds.size.h;
+    return diameter * 355 / 113 + 1;
+}
+
+static int radial_step(const RadialWidget *widget, int32_t progress) {
+    return (progress * widget->steps + PROGRESS_MAX / 2) / PROGRESS_MAX;
+}
+
+static void radial_draw(GContext *ctx, const RadialWidget *widget, GRect bounds) {
+    int32_t progress = widget->step * PROGRESS_MAX / widget->steps;
 
     // graphics_context_set_fill_color(ctx, widget->bg_color);
     // graphics_fill_rect(ctx, bounds, 0, GCornerNone);
@@ -13,13 +28,13 @@ void widget_radial_update(Layer *layer, GContext *ctx) {
     graphics_context_set_fill_color(ctx, widget->fg_color);
     
     if (widget->clockwise) {
-        int start_angle = DEG_TO_TRIGANGLE(0);
-        int end_angle = DEG_TO_TRIGANGLE(360 * widget->progress);
+        int start_angle = 0;
+        int end_angle = progress;
         graphics_fill_radial(
             ctx, bounds, GOvalScaleModeFitCircle,
             widget->line_thickness, start_angle, end_angle);
     } else {
-        int start_angle = DEG_TO_TRIGANGLE(360 * (1.0 - widget->progress));
+        int start_angle = TRIG_MAX_ANGLE - progress;
         int end_angle = DEG_TO_TRIGANGLE(359);
         graphics_fill_radial(
             ctx, bounds, GOvalScaleModeFitCircle,
@@ -27,64 +42,98 @@ void widget_radial_update(Layer *layer, GContext *ctx) {
     }
 }
 
+void widget_radial_update(Layer *layer, GContext *ctx) {
+    RadialWidget *widget = widget_layer_get(layer);
+    if (widget->cache_valid && fb_cache_copy(ctx, layer, widget->cache, false)) return;
+
+    radial_draw(ctx, widget, layer_get_bounds(layer));
+    if (widget->cache) {
+        widget->cache_valid = fb_cache_copy(ctx, layer, widget->cache, true);
+    }
+}
+
 RadialWidget *widget_radial_create(
     GRect bounds,
     GColor bg_color,
     GColor fg_color,
     int line_thickness,
     bool clockwise,
-    GFont font,
+    uint32_t font_id,
     int line_height
 ) {
-    RadialWidget *widget = malloc(sizeof(RadialWidget));
+    RadialWidget *widget = widget_layer_create("radial", bounds, sizeof(RadialWidget));
     if (!widget) return NULL;
 
-    widget->layer = layer_create_with_data(bounds, sizeof(RadialWidget *));
-    if (!widget->layer) {
-        free(widget);
-        return NULL;
-    }
-
-    // Attach user data
-    *(RadialWidget **)layer_get_data(widget->layer) = widget;
-    layer_set_update_proc(widget->layer, widget_radial_update);
+    layer_set_update_proc(widget->layer, RENDER_TIMED(widget_radial_update));
 
     widget->line_thickness = line_thickness;
     widget->bg_color = bg_color;
     widget->fg_color = fg_color; 
-    widget->font = font;
+    widget->font_id = font_id;
     widget->line_height = line_height;
-    widget->progress = 0.0f; // Default progress
+    widget->progress = 0; // Default progress
+    widget->target = 0;
     widget->clockwise = clockwise;
+    widget->steps = radial_steps(bounds);
+    widget->step = 0;
+    widget->cache_valid = false;
+    // Without the cache the ring is simply drawn on every redraw.
+    widget->cache = heap_track_sdk("radial", fb_cache_create(bounds.size));
 
-    // Create and add text layer
+    // Create and add the label, kept inside the ring's layer
     int text_top = (bounds.size.h - line_height) / 2;
-    widget->text_layer = text_layer_create(GRect(0, text_top, bounds.size.w, bounds.size.h));
-    text_layer_set_background_color(widget->text_layer, GColorClear);
-    text_layer_set_text_color(widget->text_layer, fg_color);
-    text_layer_set_font(widget->text_layer, widget->font);
-    text_layer_set_text_alignment(widget->text_layer, GTextAlignmentCenter);
-    
-    layer_add_child(widget->layer, text_layer_get_layer(widget->text_layer));
+    GRect text_frame = GRect(0, text_top, bounds.size.w, bounds.size.h - text_top);
+    widget->label = widget_glyph_text_create(text_frame, widget->font_id, fg_color, GTextAlignmentCenter,
+                                             GLYPH_TEXT_DIGITS);
+    if (widget->label) layer_add_child(widget->layer, widget->label->layer);
 
     return widget;
 }
 
-void widget_radial_set(RadialWidget *widget, const char *text, float progress) {
-    if (widget && widget->text_layer) {
-        text_layer_set_text(widget->text_layer, text);
-        widget->progress = progress;
+// Sweep frames and set values that don't move the ring by a step aren't redrawn.
+static void radial_apply_progress(void *radial, int32_t progress) {
+    RadialWidget *widget = radial;
+    widget->progress = progress;
+    int step = radial_step(widget, progress);
+    if (step != widget->step) {
+        widget->step = step;
+        widget->cache_valid = false;
         layer_mark_dirty(widget->layer);
     }
 }
 
+void widget_radial_set(RadialWidget *widget, const char *text, int32_t progress) {
+    if (widget && widget->label) {
+        transition_stop(widget);
+        widget_glyph_text_set(widget->label, text);
+        widget->target = progress;
+        radial_apply_progress(widget, progress);
+    }
+}
+
+void widget_radial_sweep(RadialWidget *widget, const char *text, int32_t progress, uint32_t duration_ms) {
+    if (!widget || !widget->label) return;
+    widget_glyph_text_set(widget->label, text);
+    widget->target = progress;
+    transition_start(widget, widget->layer, radial_apply_progress, widget->progress, progress, duration_ms);
+}
+
 void widget_radial_destroy(RadialWidget *widget) {
     if (!widget) return;
-    if (widget->text_layer) {
-        text_layer_destroy(widget->text_layer);
-    }
-    if (widget->layer) {
-        layer_destroy(widget->layer);
-    }
-    free(widget);
+    transition_stop(widget);
+    widget_glyph_text_destroy(widget->label);
+    heap_track_sdk_release(widget->cache);
+    gbitmap_destroy(widget->cache);
+    widget_layer_destroy(widget);
+}
+
+// widget class -------------------------------------------------------------------
+
+static void radial_destroy(void *widget) {
+    widget_radial_destroy(widget);
 }
+
+const WidgetClass RADIAL_WIDGET_CLASS = {
+    .name = "radial",
+    .destroy = radial_destroy,
+};
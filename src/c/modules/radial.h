@@ -1,5 +1,8 @@
 #pragma once
 #include <pebble.h>
+#include "progress.h"
+#include "glyph_text.h"
+#include "widget.h"
 
 typedef struct {
     Layer *layer; // Layer to draw the widget
@@ -11,24 +14,43 @@ typedef struct {
     // radial properties
     int line_thickness;
     bool clockwise;
-    float progress;
+    int32_t progress; // fraction of PROGRESS_MAX
+    int32_t target;   // where a sweep is taking `progress`, or `progress`
+
+    // The ring is drawn at one of `steps` positions, one per pixel of its
+    // outer edge, and kept in `cache` until the position changes.
+    int steps;
+    int step;
+    GBitmap *cache; // the drawn ring and what's under it, in the framebuffer's format
+    bool cache_valid;
     
     // text properties
-    TextLayer *text_layer;
+    GlyphTextWidget *label;
     int line_height;
-    GFont font;
+    uint32_t font_id; // custom font resource
 } RadialWidget;
 
+// The ring is cached together with its background, so radials must sit on a
+// background that doesn't change under them.
+
 RadialWidget *widget_radial_create(
     GRect bounds,
     GColor bg_color,
     GColor fg_color,
     int line_thickness,
     bool clockwise,
-    GFont font,
+    uint32_t font_id,
     int line_height
 );
 void widget_radial_destroy(RadialWidget *widget);
 void widget_radial_update(Layer *layer, GContext *ctx);
 
-void widget_radial_set(RadialWidget *widget, const char *text, float progress);
\ No newline at end of file
+// Redraws the ring only if `progress` moves it by a step.
+void widget_radial_set(RadialWidget *widget, const char *text, int32_t progress);
+
+// Like widget_radial_set(), but the ring sweeps to `progress`; the text
+// changes at once.
+void widget_radial_sweep(RadialWidget *widget, const char *text, int32_t progress, uint32_t duration_ms);
+
+// What a radial shows is up to the face, so the class has no tick handler.
+extern const WidgetClass RADIAL_WIDGET_CLASS;
@@ -0,0 +1,75 @@
+#include <pebble.h>
+#include "render_timing.h"
+
+#if defined(RENDER_TIMING)
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint16_t samples[RENDER_TIMING_SAMPLES]; // ms, ring buffer
+    uint8_t next;
+} ProcTiming;
+
+static ProcTiming s_procs[RENDER_TIMING_MAX_PROCS];
+static uint32_t s_last_dump;
+
+uint32_t render_timing_now(void) {
+    time_t seconds;
+    uint16_t ms;
+    time_ms(&seconds, &ms);
+    return (uint32_t)seconds * 1000 + ms;
+}
+
+// Names are the string literals from RENDER_TIMING_WRAP, so pointers compare.
+static ProcTiming *proc_timing(const char *name) {
+    for (int i = 0; i < RENDER_TIMING_MAX_PROCS; i++) {
+        if (s_procs[i].name == name) return &s_procs[i];
+        if (!s_procs[i].name) {
+            s_procs[i].name = name;
+            return &s_procs[i];
+        }
+    }
+    return NULL;
+}
+
+void render_timing_record(const char *name, uint32_t start_ms) {
+    uint32_t now = render_timing_now();
+    ProcTiming *timing = proc_timing(name);
+    if (timing) {
+        uint32_t elapsed = now - start_ms;
+        timing->samples[timing->next] = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+        timing->next = (timing->next + 1) % RENDER_TIMING_SAMPLES;
+        timing->count++;
+    }
+
+    if (!s_last_dump) {
+        s_last_dump = now;
+    } else if (now - s_last_dump >= RENDER_TIMING_DUMP_MS) {
+        render_timing_dump();
+        s_last_dump = now;
+    }
+}
+
+void render_timing_dump(void) {
+    for (int i = 0; i < RENDER_TIMING_MAX_PROCS && s_procs[i].name; i++) {
+        const ProcTiming *timing = &s_procs[i];
+        int samples = timing->count < RENDER_TIMING_SAMPLES ? (int)timing->count : RENDER_TIMING_SAMPLES;
+        uint32_t min = UINT16_MAX, max = 0, sum = 0;
+        for (int s = 0; s < samples; s++) {
+            uint16_t ms = timing->samples[s];
+            if (ms < min) min = ms;
+            if (ms > max) max = ms;
+            sum += ms;
+        }
+        if (!samples) min = 0;
+        APP_LOG(APP_LOG_LEVEL_INFO, "render %s: %lu calls, last %d: min %lu avg %lu max %lu ms", timing->name,
+                (unsigned long)timing->count, samples, (unsigned long)min,
+                (unsigned long)(samples ? sum / samples : 0), (unsigned long)max);
+    }
+}
+
+void render_timing_phase(const char *phase, uint32_t start_ms) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "startup %s: %lu ms", phase, (unsigned long)(render_timing_now() - start_ms));
+}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#include <pebble.h>
+
+// Wall time of layer update procs, measured with time_ms() so it works on the
+// watch. Built in with RENDER_TIMING (`pebble build -- --render-timing`, or
+// `make host RENDER_TIMING=1`); without it everything below compiles away.
+//
+// Each proc keeps its invocation count and its last RENDER_TIMING_SAMPLES
+// durations in a ring buffer. Every RENDER_TIMING_DUMP_MS the min/avg/max over
+// those samples are logged with APP_LOG.
+//
+//   RENDER_TIMING_WRAP(my_update_proc)     // after my_update_proc is declared
+//   layer_set_update_proc(layer, RENDER_TIMED(my_update_proc));
+
+#define RENDER_TIMING_SAMPLES 16
+#ifndef RENDER_TIMING_DUMP_MS
+#define RENDER_TIMING_DUMP_MS 60000
+#endif
+
+#if defined(RENDER_TIMING)
+
+#define RENDER_TIMING_MAX_PROCS 12
+
+uint32_t render_timing_now(void);
+void render_timing_record(const char *name, uint32_t start_ms);
+void render_timing_dump(void);
+
+// Logs a startup phase that began at `start_ms`, e.g. the part of window load
+// that comes before the first frame.
+void render_timing_phase(const char *phase, uint32_t start_ms);
+
+#define RENDER_TIMED(proc) proc##_timed
+#define RENDER_TIMING_WRAP(proc)                                         \
+    static void proc##_timed(Layer *layer, GContext *ctx) {              \
+        uint32_t start = render_timing_now();                            \
+        proc(layer, ctx);                                                \
+        render_timing_record(#proc, start);                              \
+    }
+
+#else
+
+#define RENDER_TIMED(proc) proc
+#define RENDER_TIMING_WRAP(proc)
+#define render_timing_now() 0
+#define render_timing_phase(phase, start_ms) ((void)(start_ms))
+#define render_timing_dump() ((void)0)
+
+#endif
@@ -0,0 +1,84 @@
+#include <pebble.h>
+#include <stddef.h>
+#include <string.h>
+#include "settings.h"
+
+static const Settings DEFAULTS = {
+    .version = SETTINGS_VERSION,
+    .theme = SETTINGS_THEME_DARK,
+    .hourly_chime = false,
+    .battery = SETTINGS_BATTERY_RING,
+    .power = SETTINGS_POWER_AUTO,
+};
+
+static Settings s_settings = DEFAULTS;
+static SettingsHandler s_handler;
+
+const Settings *settings_load(void) {
+    Settings stored = DEFAULTS;
+    int size = persist_read_data(SETTINGS_PERSIST_KEY, &stored, sizeof(stored));
+    if (size <= (int)offsetof(Settings, theme) || !stored.version || stored.version > SETTINGS_VERSION) {
+        s_settings = DEFAULTS;
+        return &s_settings;
+    }
+
+    // an older, shorter struct leaves the newer fields at their defaults
+    stored.version = SETTINGS_VERSION;
+    if (stored.theme >= SETTINGS_THEME_COUNT) stored.theme = DEFAULTS.theme;
+    if (stored.hourly_chime > 1) stored.hourly_chime = DEFAULTS.hourly_chime;
+    if (stored.battery >= SETTINGS_BATTERY_COUNT) stored.battery = DEFAULTS.battery;
+    if (stored.power >= SETTINGS_POWER_COUNT) stored.power = DEFAULTS.power;
+    s_settings = stored;
+    return &s_settings;
+}
+
+const Settings *settings_get(void) {
+    return &s_settings;
+}
+
+// The value of an integer tuple of any width, or -1.
+static int32_t tuple_int(const Tuple *tuple) {
+    if (!tuple || (tuple->type != TUPLE_INT && tuple->type != TUPLE_UINT)) return -1;
+    const bool is_signed = tuple->type == TUPLE_INT;
+    switch (tuple->length) {
+        case 1:
+            return is_signed ? tuple->value->int8 : tuple->value->uint8;
+        case 2:
+            return is_signed ? tuple->value->int16 : tuple->value->uint16;
+        case 4:
+            return is_signed ? tuple->value->int32 : (int32_t)tuple->value->uint32;
+        default:
+            return -1;
+    }
+}
+
+// Sets `field` from the tuple under `key`, if there is one with a value below `count`.
+static void settings_take(DictionaryIterator *iter, uint32_t key, uint8_t *field, int count) {
+    int32_t value = tuple_int(dict_find(iter, key));
+    if (value >= 0 && value < count) *field = value;
+}
+
+static void settings_inbox_received(DictionaryIterator *iter, void *context) {
+    Settings next = s_settings;
+    settings_take(iter, MESSAGE_KEY_THEME, &next.theme, SETTINGS_THEME_COUNT);
+    settings_take(iter, MESSAGE_KEY_HOURLY_CHIME, &next.hourly_chime, 2);
+    settings_take(iter, MESSAGE_KEY_BATTERY, &next.battery, SETTINGS_BATTERY_COUNT);
+    settings_take(iter, MESSAGE_KEY_POWER, &next.power, SETTINGS_POWER_COUNT);
+    if (!memcmp(&next, &s_settings, sizeof(Settings))) return;
+
+    const Settings previous = s_settings;
+    s_settings = next;
+    persist_write_data(SETTINGS_PERSIST_KEY, &s_settings, sizeof(s_settings));
+    if (s_handler) s_handler(&s_settings, &previous);
+}
+
+void settings_listen(SettingsHandler handler) {
+    s_handler = handler;
+    app_message_register_inbox_received(settings_inbox_received);
+    app_message_open(SETTINGS_INBOX_SIZE, 0);
+}
+
+void settings_deinit(void) {
+    app_message_deregister_callbacks();
+    s_handler = NULL;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <pebble.h>
+
+// The face's runtime settings, kept in persistent storage as one packed,
+// versioned struct: init reads them with a single persist_read_data(), so the
+// first frame needs nothing from the phone. The phone changes them over
+// AppMessage (src/pkjs/index.js), with one MESSAGE_KEY_* per field.
+//
+// Fields are only ever added at the end. A face reading the struct of an
+// older one keeps the fields stored and defaults the ones added since; the
+// struct of a newer face is ignored.
+#define SETTINGS_PERSIST_KEY 1
+#define SETTINGS_VERSION 1
+#define SETTINGS_INBOX_SIZE 64
+
+typedef enum {
+    SETTINGS_THEME_DARK,
+    SETTINGS_THEME_LIGHT, // the dark face, inverted
+    SETTINGS_THEME_COUNT,
+} SettingsTheme;
+
+typedef enum {
+    SETTINGS_BATTERY_RING,
+    SETTINGS_BATTERY_HIDDEN,
+    SETTINGS_BATTERY_COUNT,
+} SettingsBattery;
+
+typedef enum {
+    SETTINGS_POWER_AUTO,  // profiles follow the battery
+    SETTINGS_POWER_SAVER, // the saver profile, always
+    SETTINGS_POWER_COUNT,
+} SettingsPower;
+
+typedef struct __attribute__((__packed__)) {
+    uint8_t version;
+    uint8_t theme;        // SettingsTheme
+    uint8_t hourly_chime; // vibrate on the hour, outside quiet time
+    uint8_t battery;      // SettingsBattery
+    uint8_t power;        // SettingsPower
+} Settings;
+
+// Called after a message changed the settings, once they are stored.
+typedef void (*SettingsHandler)(const Settings *settings, const Settings *previous);
+
+// Reads the stored settings, or takes the defaults.
+const Settings *settings_load(void);
+const Settings *settings_get(void);
+
+// Opens AppMessage and applies the settings the phone sends.
+void settings_listen(SettingsHandler handler);
+void settings_deinit(void);
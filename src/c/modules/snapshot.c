@@ -0,0 +1,305 @@
+#include <pebble.h>
+#include <string.h>
+#include "snapshot.h"
+#include "widget_alloc.h"
+#include "render_timing.h"
+#include "transition.h"
+
+RENDER_TIMING_WRAP(widget_snapshot_update)
+RENDER_TIMING_WRAP(widget_snapshot_capture_update)
+
+#define SNAPSHOT_VERSION 1
+
+typedef struct {
+    uint8_t version;
+    uint8_t format;
+    uint16_t width;
+    uint16_t height;
+    uint16_t size;
+    int32_t minute;
+    uint8_t palette[SNAPSHOT_PALETTE_SIZE];
+} SnapshotHeader;
+
+static int32_t snapshot_minute_now(void) {
+    return (int32_t)(time(NULL) / SECONDS_PER_MINUTE);
+}
+
+// PackBits --------------------------------------------------------------------------
+
+// Appends one row; runs and literals never cross rows. False when `out` is full.
+static bool packbits_row(const uint8_t *src, int length, uint8_t *out, int capacity, int *pos) {
+    int i = 0;
+    while (i < length) {
+        int run = 1;
+        while (i + run < length && run < 128 && src[i + run] == src[i]) run++;
+        if (run > 1) {
+            if (*pos + 2 > capacity) return false;
+            out[(*pos)++] = (uint8_t)(1 - run);
+            out[(*pos)++] = src[i];
+            i += run;
+            continue;
+        }
+
+        int start = i++;
+        while (i < length && i - start < 128 && !(i + 1 < length && src[i] == src[i + 1])) i++;
+        if (*pos + 1 + (i - start) > capacity) return false;
+        out[(*pos)++] = (uint8_t)(i - start - 1);
+        memcpy(out + *pos, src + start, i - start);
+        *pos += i - start;
+    }
+    return true;
+}
+
+// Streams the persisted frame back one chunk at a time.
+typedef struct {
+    uint32_t key;
+    int left; // bytes not yet read from storage
+    int pos;
+    int length;
+    uint8_t buffer[PERSIST_DATA_MAX_LENGTH];
+} SnapshotReader;
+
+static int reader_next(SnapshotReader *reader) {
+    if (reader->pos == reader->length) {
+        if (reader->left <= 0) return -1;
+        int size = reader->left < PERSIST_DATA_MAX_LENGTH ? reader->left : PERSIST_DATA_MAX_LENGTH;
+        if (persist_read_data(reader->key++, reader->buffer, size) != size) return -1;
+        reader->left -= size;
+        reader->pos = 0;
+        reader->length = size;
+    }
+    return reader->buffer[reader->pos++];
+}
+
+static bool unpackbits_row(SnapshotReader *reader, uint8_t *dst, int length) {
+    int i = 0;
+    while (i < length) {
+        int code = reader_next(reader);
+        if (code < 0) return false;
+        int count = code < 128 ? code + 1 : 257 - code;
+        if (i + count > length) return false;
+        if (code < 128) {
+            for (int n = 0; n < count; n++) {
+                int byte = reader_next(reader);
+                if (byte < 0) return false;
+                dst[i++] = byte;
+            }
+        } else {
+            int byte = reader_next(reader);
+            if (byte < 0) return false;
+            memset(dst + i, byte, count);
+            i += count;
+        }
+    }
+    return true;
+}
+
+// rows ---------------------------------------------------------------------------
+
+// Rows cover the pixels the framebuffer has: all of them on rectangular
+// screens, the visible span on round ones. 1-bit rows are kept as they are,
+// 8-bit rows as 2-bit indices into the frame's palette, and each is XORed with
+// the row above before it is compressed, so what repeats down the screen
+// (digit strokes, the sides of the ring) packs into runs of zeros.
+#define SNAPSHOT_ROW_BYTES ((PBL_DISPLAY_WIDTH + 3) / 4)
+
+static int row_length(const GBitmapDataRowInfo *info, bool one_bit) {
+    if (one_bit) return (info->max_x >> 3) - (info->min_x >> 3) + 1;
+    return (info->max_x - info->min_x + 4) / 4;
+}
+
+// -1 if the row brings a color the palette has no room for. `invert` undoes an
+// inverting layer over the capture layer.
+static int row_pack(SnapshotHeader *header, int *colors, const GBitmapDataRowInfo *info, bool one_bit,
+                    bool invert, uint8_t *packed) {
+    const int length = row_length(info, one_bit);
+    if (one_bit) {
+        memcpy(packed, info->data + (info->min_x >> 3), length);
+        if (invert) {
+            for (int i = 0; i < length; i++) packed[i] ^= 0xff;
+        }
+        return length;
+    }
+
+    const uint8_t flip = invert ? 0x3f : 0; // the color bits; alpha stays
+    for (int x = info->min_x, i = 0; x <= info->max_x; x++, i++) {
+        const uint8_t color = info->data[x] ^ flip;
+        int index = 0;
+        while (index < *colors && header->palette[index] != color) index++;
+        if (index == *colors) {
+            if (index == SNAPSHOT_PALETTE_SIZE) return -1;
+            header->palette[(*colors)++] = color;
+        }
+        packed[i >> 2] |= index << ((i & 3) * 2);
+    }
+    return length;
+}
+
+static void row_unpack(const SnapshotHeader *header, const uint8_t *packed, GBitmapDataRowInfo *info,
+                       bool one_bit) {
+    if (one_bit) {
+        memcpy(info->data + (info->min_x >> 3), packed, row_length(info, one_bit));
+        return;
+    }
+    for (int x = info->min_x, i = 0; x <= info->max_x; x++, i++) {
+        info->data[x] = header->palette[(packed[i >> 2] >> ((i & 3) * 2)) & 3];
+    }
+}
+
+// drawing ------------------------------------------------------------------------
+
+void widget_snapshot_update(Layer *layer, GContext *ctx) {
+    SnapshotHeader header;
+    if (persist_read_data(SNAPSHOT_PERSIST_KEY, &header, sizeof(header)) != sizeof(header)) return;
+
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return;
+    const bool one_bit = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+    const GRect bounds = gbitmap_get_bounds(fb);
+
+    // heap-free: the frame goes from storage straight into the framebuffer
+    SnapshotReader reader = {.key = SNAPSHOT_PERSIST_KEY + 1, .left = header.size};
+    uint8_t above[SNAPSHOT_ROW_BYTES] = {0};
+    for (int y = 0; y < bounds.size.h; y++) {
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+        const int length = row_length(&info, one_bit);
+        uint8_t packed[SNAPSHOT_ROW_BYTES] = {0};
+        if (!unpackbits_row(&reader, packed, length)) break;
+        for (int i = 0; i < length; i++) packed[i] ^= above[i];
+        memcpy(above, packed, sizeof(above));
+        row_unpack(&header, packed, &info, one_bit);
+    }
+    graphics_release_frame_buffer(ctx, fb);
+}
+
+// Compresses the framebuffer into the widget's buffer, filling in the header.
+// False for a frame too busy to fit, or with too many colors.
+static bool snapshot_pack(SnapshotWidget *widget, GBitmap *fb, SnapshotHeader *header) {
+    const bool one_bit = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+    const GRect bounds = gbitmap_get_bounds(fb);
+
+    int size = 0;
+    int colors = 0;
+    uint8_t above[SNAPSHOT_ROW_BYTES] = {0};
+    for (int y = 0; y < bounds.size.h; y++) {
+        GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+        uint8_t packed[SNAPSHOT_ROW_BYTES] = {0};
+        const int length = row_pack(header, &colors, &info, one_bit, widget->inverted, packed);
+        if (length < 0) return false;
+        // `above` becomes the delta to compress, then the row again
+        for (int i = 0; i < length; i++) above[i] ^= packed[i];
+        if (!packbits_row(above, length, widget->data, SNAPSHOT_MAX_BYTES, &size)) return false;
+        memcpy(above, packed, sizeof(above));
+    }
+    header->size = size;
+    return true;
+}
+
+// Packs the first settled frame of each minute, the one the next launch in
+// that minute would show; later frames in the minute are left alone.
+void widget_snapshot_capture_update(Layer *layer, GContext *ctx) {
+    SnapshotWidget *widget = *(SnapshotWidget **)layer_get_data(layer);
+    const int32_t minute = snapshot_minute_now();
+    if (!widget->data || widget->minute == minute || transition_any_running()) return;
+
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return;
+    SnapshotHeader header = {0};
+    const bool ok = snapshot_pack(widget, fb, &header);
+    graphics_release_frame_buffer(ctx, fb);
+
+    // a frame that can't be kept isn't tried again this minute
+    widget->minute = minute;
+    widget->size = ok ? header.size : 0;
+    memcpy(widget->palette, header.palette, sizeof(widget->palette));
+}
+
+// widget -------------------------------------------------------------------------
+
+static bool snapshot_is_current(void) {
+    SnapshotHeader header;
+    if (persist_read_data(SNAPSHOT_PERSIST_KEY, &header, sizeof(header)) != sizeof(header)) return false;
+    return header.version == SNAPSHOT_VERSION &&
+           header.format == PBL_IF_BW_ELSE(GBitmapFormat1Bit, GBitmapFormat8Bit) &&
+           header.width == PBL_DISPLAY_WIDTH && header.height == PBL_DISPLAY_HEIGHT &&
+           header.minute == snapshot_minute_now();
+}
+
+SnapshotWidget *widget_snapshot_create(GRect frame) {
+    SnapshotWidget *widget = widget_layer_create("snapshot", frame, sizeof(SnapshotWidget));
+    if (!widget) return NULL;
+
+    widget->capture_layer = heap_track_sdk("snapshot", layer_create_with_data(frame, sizeof(SnapshotWidget *)));
+    if (!widget->capture_layer) {
+        widget_snapshot_destroy(widget);
+        return NULL;
+    }
+
+    // Attach user data
+    *(SnapshotWidget **)layer_get_data(widget->capture_layer) = widget;
+    widget->minute = -1;
+    layer_set_update_proc(widget->layer, RENDER_TIMED(widget_snapshot_update));
+    layer_set_update_proc(widget->capture_layer, RENDER_TIMED(widget_snapshot_capture_update));
+
+    layer_set_hidden(widget->layer, !snapshot_is_current());
+    return widget;
+}
+
+void widget_snapshot_capture(SnapshotWidget *widget, Layer *parent) {
+    if (!widget) return;
+    layer_set_hidden(widget->layer, true);
+    if (!widget->data) widget->data = widget_alloc("snapshot", SNAPSHOT_MAX_BYTES);
+    layer_add_child(parent, widget->capture_layer);
+}
+
+void widget_snapshot_set_inverted(SnapshotWidget *widget, bool inverted) {
+    if (!widget || widget->inverted == inverted) return;
+    widget->inverted = inverted;
+    widget->minute = -1;
+}
+
+void widget_snapshot_save(SnapshotWidget *widget) {
+    // only the minute's frame: one it couldn't keep leaves the stored one stale
+    if (!widget || widget->minute != snapshot_minute_now() || !widget->size) return;
+
+    for (int offset = 0, key = SNAPSHOT_PERSIST_KEY + 1; offset < widget->size;
+         offset += PERSIST_DATA_MAX_LENGTH, key++) {
+        int size = widget->size - offset < PERSIST_DATA_MAX_LENGTH ? widget->size - offset : PERSIST_DATA_MAX_LENGTH;
+        if (persist_write_data(key, widget->data + offset, size) != size) {
+            persist_delete(SNAPSHOT_PERSIST_KEY);
+            return;
+        }
+    }
+    SnapshotHeader header = {
+        .version = SNAPSHOT_VERSION,
+        .format = PBL_IF_BW_ELSE(GBitmapFormat1Bit, GBitmapFormat8Bit),
+        .width = PBL_DISPLAY_WIDTH,
+        .height = PBL_DISPLAY_HEIGHT,
+        .size = widget->size,
+        .minute = widget->minute,
+    };
+    memcpy(header.palette, widget->palette, sizeof(header.palette));
+    persist_write_data(SNAPSHOT_PERSIST_KEY, &header, sizeof(header));
+}
+
+void widget_snapshot_destroy(SnapshotWidget *widget) {
+    if (!widget) return;
+    widget_snapshot_save(widget);
+    widget_free(widget->data);
+    if (widget->capture_layer) {
+        heap_track_sdk_release(widget->capture_layer);
+        layer_destroy(widget->capture_layer);
+    }
+    widget_layer_destroy(widget);
+}
+
+// widget class -------------------------------------------------------------------
+
+static void snapshot_destroy(void *widget) {
+    widget_snapshot_destroy(widget);
+}
+
+const WidgetClass SNAPSHOT_WIDGET_CLASS = {
+    .name = "snapshot",
+    .destroy = snapshot_destroy,
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <pebble.h>
+#include "widget.h"
+
+// The last frame the face showed, kept in persistent storage so the next
+// launch has something to show before its widgets are built.
+//
+// Its layer sits under the face and draws the persisted frame, if it was
+// taken in the current minute, until widget_snapshot_capture() is called
+// once the face is complete. From then on a second layer over the face packs
+// the first settled frame of each minute (drawn with no transition running)
+// from the framebuffer, PackBits-compressed, into a buffer held until the
+// widget is destroyed, which writes it to storage. Color frames are kept as
+// indices into a palette of up to SNAPSHOT_PALETTE_SIZE colors (this face is
+// black, white and grays); a frame with more colors or too big to store is
+// not kept.
+#define SNAPSHOT_PERSIST_KEY 100 // header; the frame follows in up to SNAPSHOT_CHUNKS keys
+#define SNAPSHOT_CHUNKS 12
+#define SNAPSHOT_MAX_BYTES (SNAPSHOT_CHUNKS * PERSIST_DATA_MAX_LENGTH)
+#define SNAPSHOT_PALETTE_SIZE 4
+
+typedef struct {
+    Layer *layer;         // under the face: the persisted frame
+    Layer *capture_layer; // over the face: packs a frame a minute into `data`
+    uint8_t *data;        // SNAPSHOT_MAX_BYTES while capturing
+    int32_t minute;       // of the frame in `data`, or -1 for none
+    uint16_t size;        // bytes of it
+    uint8_t palette[SNAPSHOT_PALETTE_SIZE];
+    bool inverted;        // a layer over the capture layer inverts the frame
+} SnapshotWidget;
+
+// The layer is hidden when there is no frame from this minute to show.
+SnapshotWidget *widget_snapshot_create(GRect frame);
+void widget_snapshot_destroy(SnapshotWidget *widget);
+void widget_snapshot_update(Layer *layer, GContext *ctx);
+void widget_snapshot_capture_update(Layer *layer, GContext *ctx);
+
+// Hides the persisted frame and starts capturing frames, from a layer added
+// on top of `parent`; call after the face's last layer is added.
+void widget_snapshot_capture(SnapshotWidget *widget, Layer *parent);
+
+// For an inverting layer above the capture layer (the light theme): the frame
+// is stored as drawn below it, which is what the next launch draws under it.
+// A change takes a new frame.
+void widget_snapshot_set_inverted(SnapshotWidget *widget, bool inverted);
+
+// Writes the packed frame to storage; destroying the widget does this too.
+// Until a frame is packed the stored one is left alone.
+void widget_snapshot_save(SnapshotWidget *widget);
+
+// Nothing to tick: the snapshot is taken from the frames, not the clock.
+extern const WidgetClass SNAPSHOT_WIDGET_CLASS;
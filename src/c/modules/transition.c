@@ -0,0 +1,182 @@
+#include <pebble.h>
+#include "transition.h"
+
+typedef struct {
+    void *widget;
+    TransitionApply apply;
+    Animation *animation;
+
+    int32_t values[TRANSITION_MAX_FRAMES + 1]; // eased, values[frames] is the end value
+    int frames;
+    int frame;   // last frame applied
+    int skipped; // frames dropped to stay within the draw budget
+
+    // markers drawn around the widget's layer, timing its draw
+    Layer *begin;
+    Layer *end;
+    uint32_t draw_start;
+    uint32_t draw_ms; // the last draw, 0 until one was timed
+} Transition;
+
+static Transition s_transitions[TRANSITION_MAX];
+static bool s_enabled = true;
+static uint32_t s_skipped_total;
+
+static uint32_t transition_now(void) {
+    time_t seconds;
+    uint16_t ms;
+    time_ms(&seconds, &ms);
+    return (uint32_t)seconds * 1000 + ms;
+}
+
+static Transition *transition_find(void *widget) {
+    for (int i = 0; i < TRANSITION_MAX; i++) {
+        if (s_transitions[i].widget == widget) return &s_transitions[i];
+    }
+    return NULL;
+}
+
+// draw timing ----------------------------------------------------------------------
+
+static void marker_begin(Layer *layer, GContext *ctx) {
+    Transition *transition = *(Transition **)layer_get_data(layer);
+    transition->draw_start = transition_now();
+}
+
+static void marker_end(Layer *layer, GContext *ctx) {
+    Transition *transition = *(Transition **)layer_get_data(layer);
+    transition->draw_ms = transition_now() - transition->draw_start;
+}
+
+static Layer *marker_create(Transition *transition, Layer *layer, LayerUpdateProc proc) {
+    Layer *marker = layer_create_with_data(layer_get_frame(layer), sizeof(Transition *));
+    if (marker) {
+        *(Transition **)layer_get_data(marker) = transition;
+        layer_set_update_proc(marker, proc);
+        if (proc == marker_begin) {
+            layer_insert_below_sibling(marker, layer);
+        } else {
+            layer_insert_above_sibling(marker, layer);
+        }
+    }
+    return marker;
+}
+
+static void marker_destroy(Layer **marker) {
+    if (!*marker) return;
+    layer_remove_from_parent(*marker);
+    layer_destroy(*marker);
+    *marker = NULL;
+}
+
+// animation ------------------------------------------------------------------------
+
+static void transition_update(Animation *animation, const AnimationProgress progress) {
+    Transition *transition = animation_get_context(animation);
+    int frame = (int)((int64_t)progress * transition->frames / ANIMATION_NORMALIZED_MAX);
+    if (frame <= transition->frame) return;
+
+    // a draw over budget holds the next frame back, and one more for every frame it overran
+    if (frame < transition->frames && transition->draw_ms > TRANSITION_DRAW_BUDGET_MS) {
+        int hold = 1 + transition->draw_ms / TRANSITION_FRAME_MS;
+        if (frame <= transition->frame + hold) {
+            transition->skipped++;
+            s_skipped_total++;
+            return;
+        }
+    }
+    transition->frame = frame;
+    transition->apply(transition->widget, transition->values[frame]);
+}
+
+static void transition_stopped(Animation *animation, bool finished, void *context) {
+    Transition *transition = context;
+    if (finished && transition->frame < transition->frames) {
+        transition->apply(transition->widget, transition->values[transition->frames]);
+    }
+    if (transition->skipped) {
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "transition: %d of %d frames skipped, draw %lu ms", transition->skipped,
+                transition->frames, (unsigned long)transition->draw_ms);
+    }
+    marker_destroy(&transition->begin);
+    marker_destroy(&transition->end);
+    *transition = (Transition){0};
+}
+
+static const AnimationImplementation TRANSITION_IMPLEMENTATION = {
+    .update = transition_update,
+};
+
+// Ease in and out: 3t^2 - 2t^3, in 1/1024ths.
+static int32_t transition_ease(int32_t from, int32_t to, int frame, int frames) {
+    int64_t t = (int64_t)frame * 1024 / frames;
+    int64_t eased = t * t * (3 * 1024 - 2 * t) / (1024 * 1024);
+    return from + (int32_t)((to - from) * eased / 1024);
+}
+
+bool transition_start(void *widget, Layer *layer, TransitionApply apply, int32_t from, int32_t to,
+                      uint32_t duration_ms) {
+    transition_stop(widget);
+    Transition *transition = s_enabled && from != to ? transition_find(NULL) : NULL;
+    int frames = duration_ms / TRANSITION_FRAME_MS;
+    if (frames > TRANSITION_MAX_FRAMES) frames = TRANSITION_MAX_FRAMES;
+    if (!transition || frames < 2) {
+        apply(widget, to);
+        return false;
+    }
+
+    *transition = (Transition){.widget = widget, .apply = apply, .frames = frames};
+    for (int i = 0; i < frames; i++) {
+        transition->values[i] = transition_ease(from, to, i, frames);
+    }
+    transition->values[frames] = to;
+
+    transition->animation = animation_create();
+    if (!transition->animation) {
+        *transition = (Transition){0};
+        apply(widget, to);
+        return false;
+    }
+    animation_set_duration(transition->animation, duration_ms);
+    animation_set_curve(transition->animation, AnimationCurveLinear);
+    animation_set_implementation(transition->animation, &TRANSITION_IMPLEMENTATION);
+    animation_set_handlers(transition->animation, (AnimationHandlers){.stopped = transition_stopped}, transition);
+    transition->begin = marker_create(transition, layer, marker_begin);
+    transition->end = marker_create(transition, layer, marker_end);
+
+    apply(widget, from);
+    animation_schedule(transition->animation);
+    return true;
+}
+
+void transition_stop(void *widget) {
+    Transition *transition = widget ? transition_find(widget) : NULL;
+    if (transition) animation_unschedule(transition->animation);
+}
+
+bool transition_running(void *widget) {
+    return widget && transition_find(widget);
+}
+
+uint32_t transition_skipped_frames(void) {
+    return s_skipped_total;
+}
+
+bool transition_any_running(void) {
+    for (int i = 0; i < TRANSITION_MAX; i++) {
+        if (s_transitions[i].widget) return true;
+    }
+    return false;
+}
+
+void transition_set_enabled(bool enabled) {
+    s_enabled = enabled;
+    if (enabled) return;
+    for (int i = 0; i < TRANSITION_MAX; i++) {
+        Transition *transition = &s_transitions[i];
+        if (!transition->widget) continue;
+        transition->frame = transition->frames;
+        transition->apply(transition->widget, transition->values[transition->frames]);
+        animation_unschedule(transition->animation);
+    }
+}
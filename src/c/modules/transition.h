@@ -0,0 +1,45 @@
+#pragma once
+#include <pebble.h>
+
+// Eased transitions of one widget value (a digit's slide offset, a ring's
+// progress), on top of the SDK Animation API, that can't turn into runaway
+// redraws:
+//
+//   - the values are computed up front, at most TRANSITION_MAX_FRAMES of
+//     them TRANSITION_FRAME_MS apart, so the widget is redrawn at most that
+//     often whatever rate the animation runs at;
+//   - the widget's draw is timed with two empty layers drawn right before and
+//     after its layer, and while a draw takes more than
+//     TRANSITION_DRAW_BUDGET_MS the frames it overran are skipped;
+//   - while transitions are disabled (e.g. in the battery saver profile)
+//     every transition jumps straight to its end value.
+#define TRANSITION_MAX 4
+#define TRANSITION_MAX_FRAMES 12
+#define TRANSITION_FRAME_MS 50
+#define TRANSITION_DRAW_BUDGET_MS 20
+
+// Shows one value of the transition, typically by storing it in the widget
+// and marking its layer dirty.
+typedef void (*TransitionApply)(void *widget, int32_t value);
+
+// Moves `widget` from `from` to `to` over `duration_ms`, replacing any
+// transition it already has. `layer` is the layer that draws the value; it
+// must have a parent. Returns false, after applying `to`, when transitions
+// are disabled or none is free.
+bool transition_start(void *widget, Layer *layer, TransitionApply apply, int32_t from, int32_t to,
+                      uint32_t duration_ms);
+
+// Stops the widget's transition where it is, e.g. before setting a value
+// directly or destroying the widget.
+void transition_stop(void *widget);
+
+bool transition_running(void *widget);
+
+// Frames skipped to stay within the draw budget, by every transition so far.
+uint32_t transition_skipped_frames(void);
+
+// Whether any transition is running, i.e. the screen is between two states.
+bool transition_any_running(void);
+
+// Disabling finishes the running transitions.
+void transition_set_enabled(bool enabled);
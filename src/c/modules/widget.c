@@ -0,0 +1,95 @@
+#include <pebble.h>
+#include "widget.h"
+
+typedef struct {
+    void *widget;
+    const WidgetClass *cls;
+    TimeUnits units;
+    WidgetTickHandler on_tick;
+} ScheduledWidget;
+
+static ScheduledWidget s_widgets[WIDGET_SCHEDULER_MAX];
+static int s_count;
+static TimeUnits s_subscribed; // the unit the tick service is subscribed at, 0 for none
+
+bool widget_scheduler_add(void *widget, const WidgetClass *cls, TimeUnits units, WidgetTickHandler on_tick) {
+    if (!widget) return false;
+    if (!on_tick && cls) {
+        on_tick = cls->on_tick;
+        if (!units) units = cls->tick_units;
+    }
+    if (!on_tick) units = 0;
+
+    if (s_count == WIDGET_SCHEDULER_MAX) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "widget scheduler full, %s not added", cls ? cls->name : "widget");
+        return false;
+    }
+    s_widgets[s_count++] = (ScheduledWidget){widget, cls, units, on_tick};
+    return true;
+}
+
+void widget_scheduler_remove(void *widget) {
+    for (int i = 0; i < s_count; i++) {
+        if (s_widgets[i].widget == widget) {
+            // keep the order widgets were added in, which is the order they tick
+            for (s_count--; i < s_count; i++) s_widgets[i] = s_widgets[i + 1];
+            return;
+        }
+    }
+}
+
+void widget_scheduler_set_units(void *widget, TimeUnits units) {
+    for (int i = 0; i < s_count; i++) {
+        if (s_widgets[i].widget == widget) {
+            s_widgets[i].units = s_widgets[i].on_tick ? units : 0;
+            return;
+        }
+    }
+}
+
+void widget_scheduler_subscribe(void) {
+    TimeUnits units = 0;
+    for (int i = 0; i < s_count; i++) {
+        units |= s_widgets[i].units;
+    }
+    // lowest set bit: the finest unit wanted, coarser changes ride along
+    units &= -units;
+    // a new subscription's first tick reports every unit as changed
+    if (units == s_subscribed) return;
+    s_subscribed = units;
+    if (!units) {
+        tick_timer_service_unsubscribe();
+        return;
+    }
+    tick_timer_service_subscribe(units, widget_scheduler_tick);
+}
+
+void widget_scheduler_tick(struct tm *tick_time, TimeUnits units_changed) {
+    for (int i = 0; i < s_count; i++) {
+        if (s_widgets[i].units & units_changed) {
+            s_widgets[i].on_tick(s_widgets[i].widget, tick_time, units_changed);
+        }
+    }
+}
+
+void widget_scheduler_refresh(void) {
+    widget_scheduler_tick(localtime(&(time_t){time(NULL)}), WIDGET_ALL_UNITS);
+}
+
+void widget_scheduler_refresh_widget(void *widget) {
+    for (int i = 0; i < s_count; i++) {
+        if (s_widgets[i].widget == widget && s_widgets[i].units) {
+            s_widgets[i].on_tick(widget, localtime(&(time_t){time(NULL)}), WIDGET_ALL_UNITS);
+            return;
+        }
+    }
+}
+
+void widget_scheduler_destroy_all(void) {
+    tick_timer_service_unsubscribe();
+    s_subscribed = 0;
+    for (int i = s_count - 1; i >= 0; i--) {
+        if (s_widgets[i].cls) s_widgets[i].cls->destroy(s_widgets[i].widget);
+    }
+    s_count = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <pebble.h>
+
+// The part of a widget module the face and the scheduler see: every widget
+// module exports one WidgetClass for its type. Creation stays with the
+// module, since each widget takes its own arguments, and drawing with the
+// update proc it gives the widget's layer.
+//
+// Setters mark a widget's layer dirty only when what it shows changes at its
+// own resolution (a ring's step, a label's text), so ticks and refreshes that
+// repeat a value don't redraw. Marks made in one event loop turn are drawn
+// in a single redraw.
+typedef void (*WidgetTickHandler)(void *widget, struct tm *tick_time, TimeUnits units_changed);
+
+typedef struct {
+    const char *name;
+    void (*destroy)(void *widget);
+
+    // How the widget follows the clock on its own, if it does; NULL when
+    // what it shows is up to the face.
+    WidgetTickHandler on_tick;
+    TimeUnits tick_units;
+} WidgetClass;
+
+// Every unit, for a tick that should reach all widgets.
+#define WIDGET_ALL_UNITS (SECOND_UNIT | MINUTE_UNIT | HOUR_UNIT | DAY_UNIT | MONTH_UNIT | YEAR_UNIT)
+
+#define WIDGET_SCHEDULER_MAX 12
+
+// The scheduler keeps the face's widgets with the time units each depends on,
+// and on every tick calls only those whose units are among the ones that
+// changed, in the order they were added. `widget` may also be a plain SDK
+// object (e.g. a TextLayer) with a NULL `cls` and its own handler.
+//
+// With `on_tick` NULL the class's handler is used, and its units unless
+// `units` is given. A widget that doesn't follow the clock (e.g. battery) is
+// kept with no units, so it is still destroyed with the rest.
+bool widget_scheduler_add(void *widget, const WidgetClass *cls, TimeUnits units, WidgetTickHandler on_tick);
+void widget_scheduler_remove(void *widget);
+
+// Changes the units a widget already added depends on.
+void widget_scheduler_set_units(void *widget, TimeUnits units);
+
+// Subscribes to the tick service at the finest unit any widget needs. Call
+// again after adding or removing widgets; an unchanged unit is left subscribed.
+void widget_scheduler_subscribe(void);
+
+// TickHandler: calls the widgets depending on any of `units_changed`.
+void widget_scheduler_tick(struct tm *tick_time, TimeUnits units_changed);
+
+// Brings every widget up to the current time, e.g. right after loading.
+void widget_scheduler_refresh(void);
+
+// The same for one widget, e.g. one added after the others were refreshed.
+void widget_scheduler_refresh_widget(void *widget);
+
+// Unsubscribes and destroys every widget that has a class, then forgets all
+// of them; the face destroys the rest itself.
+void widget_scheduler_destroy_all(void);
@@ -0,0 +1,112 @@
+#include <pebble.h>
+#include <string.h>
+#include "widget_alloc.h"
+
+#if defined(WIDGET_ARENA_SIZE)
+
+// Each block follows a header, and both are whole multiples of 8 bytes.
+typedef struct {
+    uint32_t size; // of the block with its header
+    uint32_t used;
+} ArenaHeader;
+
+static uint64_t s_arena[(WIDGET_ARENA_SIZE + 7) / 8];
+static size_t s_top; // end of the last block in use
+static size_t s_peak;
+
+static bool arena_owns(const void *ptr) {
+    const uint8_t *p = ptr;
+    return p >= (const uint8_t *)s_arena && p < (const uint8_t *)s_arena + sizeof(s_arena);
+}
+
+void *widget_alloc(const char *tag, size_t size) {
+    const size_t bytes = sizeof(ArenaHeader) + ((size + 7) & ~(size_t)7);
+    if (bytes > sizeof(s_arena) - s_top) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "widget arena full, %s takes %u B from the heap", tag, (unsigned)size);
+        return heap_track_malloc(tag, size);
+    }
+
+    ArenaHeader *header = (ArenaHeader *)((uint8_t *)s_arena + s_top);
+    *header = (ArenaHeader){.size = bytes, .used = true};
+    s_top += bytes;
+    if (s_top > s_peak) s_peak = s_top;
+    return header + 1;
+}
+
+void widget_free(void *ptr) {
+    if (!ptr) return;
+    if (!arena_owns(ptr)) {
+        heap_track_free(ptr);
+        return;
+    }
+
+    ((ArenaHeader *)ptr - 1)->used = false;
+    // drop the freed blocks above the last one still in use
+    size_t top = 0;
+    for (size_t at = 0; at < s_top;) {
+        const ArenaHeader *header = (const ArenaHeader *)((const uint8_t *)s_arena + at);
+        at += header->size;
+        if (header->used) top = at;
+    }
+    s_top = top;
+}
+
+size_t widget_arena_used(void) {
+    return s_top;
+}
+
+size_t widget_arena_peak(void) {
+    return s_peak;
+}
+
+void *widget_layer_create(const char *tag, GRect frame, size_t size) {
+    void *widget = widget_alloc(tag, size);
+    if (!widget) return NULL;
+    Layer *layer = heap_track_sdk(tag, layer_create_with_data(frame, sizeof(void *)));
+    if (!layer) {
+        widget_free(widget);
+        return NULL;
+    }
+
+    *(void **)layer_get_data(layer) = widget;
+    memset(widget, 0, size);
+    *(Layer **)widget = layer;
+    return widget;
+}
+
+void *widget_layer_get(const Layer *layer) {
+    return *(void **)layer_get_data(layer);
+}
+
+void widget_layer_destroy(void *widget) {
+    if (!widget) return;
+    Layer *layer = *(Layer **)widget;
+    heap_track_sdk_release(layer);
+    layer_destroy(layer);
+    widget_free(widget);
+}
+
+#else
+
+void *widget_layer_create(const char *tag, GRect frame, size_t size) {
+    Layer *layer = heap_track_sdk(tag, layer_create_with_data(frame, size));
+    if (!layer) return NULL;
+
+    void *widget = layer_get_data(layer);
+    memset(widget, 0, size);
+    *(Layer **)widget = layer;
+    return widget;
+}
+
+void *widget_layer_get(const Layer *layer) {
+    return layer_get_data(layer);
+}
+
+void widget_layer_destroy(void *widget) {
+    if (!widget) return;
+    Layer *layer = *(Layer **)widget;
+    heap_track_sdk_release(layer);
+    layer_destroy(layer); // frees the widget too
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <pebble.h>
+#include "heap_track.h"
+
+// Memory for the widgets. A widget's struct, whose first member is its
+// layer, is kept in that layer's data: creating a widget is one allocation.
+//
+// Built with WIDGET_ARENA_SIZE (bytes; `pebble build -- --widget-arena=N`, or
+// `make host WIDGET_ARENA=N`), the structs and the buffers widgets own come
+// from a static arena instead, and layers only point at their widget. A
+// window load/unload cycle then allocates nothing for the widgets but their
+// layers. The arena is a stack: freed blocks on top are given back, and it is
+// empty again once all of them are. Blocks that don't fit come from the heap.
+
+// A zeroed widget of `size` bytes, its first member a new layer with `frame`.
+void *widget_layer_create(const char *tag, GRect frame, size_t size);
+
+// The widget of a layer made by widget_layer_create().
+void *widget_layer_get(const Layer *layer);
+
+// Destroys the widget's layer, and with it the widget.
+void widget_layer_destroy(void *widget);
+
+// Buffers owned by widgets, e.g. caches built on first draw.
+#if defined(WIDGET_ARENA_SIZE)
+void *widget_alloc(const char *tag, size_t size);
+void widget_free(void *ptr);
+
+// Bytes of the arena in use, and the most ever used.
+size_t widget_arena_used(void);
+size_t widget_arena_peak(void);
+#else
+#define widget_alloc(tag, size) heap_track_malloc((tag), (size))
+#define widget_free(ptr) heap_track_free(ptr)
+#endif
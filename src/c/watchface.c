@@ -2,271 +2,354 @@
 #include "modules/radial.h"
 #include "modules/big_digit.h"
 #include "modules/border.h"
+#include "modules/calendar.h"
+#include "modules/glyph_text.h"
+#include "modules/heap_track.h"
+#include "modules/invert.h"
+#include "modules/power.h"
+#include "modules/render_timing.h"
+#include "modules/settings.h"
+#include "modules/snapshot.h"
+#include "modules/transition.h"
+#include "modules/widget.h"
+
+// The first frame shows only the hour digits and the minute; the rest of the
+// face is built this long after load, once that frame is on screen.
+#ifndef STARTUP_DEFER_MS
+#define STARTUP_DEFER_MS 50
+#endif
+
+// how long an hour digit slides in, and the minute ring sweeps on
+#define DIGIT_SLIDE_MS 400
+#define RING_SWEEP_MS 300
+
+// month abbreviations in the C locale, for the date line's glyph atlas
+#define DATE_CHARS GLYPH_TEXT_DIGITS "- JanFebMarAprMayJunJulAugSepOctNovDec"
 
 static Window *s_main_window;
+static AppTimer *s_startup_timer;
+static uint32_t s_load_start;
+static bool s_face_ready; // built and showing its initial values: changes from here on animate
 
 static GFont s_tiny_font;
 static GFont s_tiny_font_bold;
-static GFont s_small_font;
-static GFont s_medium_font;
-static GFont s_large_font;
 
 static RadialWidget *s_radial_battery;
 static RadialWidget *s_radial_minute;
 
 static BigDigitWidget *s_big_digit_hour_tens;
 static BigDigitWidget *s_big_digit_hour_ones;
-static TextLayer *s_minute_layer;
+static GlyphTextWidget *s_minute_text;
 
-static TextLayer *s_date_layer;
-static Layer *s_calendar_layer;
+static GlyphTextWidget *s_date_text;
+static CalendarWidget *s_calendar;
+static SnapshotWidget *s_snapshot;
+static Layer *s_invert; // over everything in the light theme
 
-static const char *DAY_LETTERS[] = {"Su", "Mo", "Tu", "We", "Th", "Fr", "Sa"};
-static int s_month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31}; // Days in each month
-
-static void draw_day_box(GContext *ctx, int x, int width, const char *label, GFont font, int y_offset)
+// tick handlers, each called by the widget scheduler only when its unit changed
+static void minute_text_tick(void *text, struct tm *tick_time, TimeUnits units_changed)
 {
-  GRect box = GRect(x, y_offset, width, 14);
-  graphics_draw_text(ctx, label, font, box, GTextOverflowModeFill, GTextAlignmentCenter, NULL);
+  static char s_minute[3]; // 34
+  strftime(s_minute, sizeof(s_minute), "%M", tick_time);
+  widget_glyph_text_set(text, s_minute);
 }
-
-static void draw_highlight_box(GContext *ctx, int x, int width, int height)
+static void hour_radial_tick(void *radial, struct tm *tick_time, TimeUnits units_changed)
 {
-  GRect highlight = GRect(x, 0, width, height);
-  graphics_context_set_stroke_color(ctx, GColorWhite);
-  graphics_fill_rect(ctx, highlight, 1, GCornersAll);
+  static char s_hour[3]; // 21
+  const PowerProfile *power = power_governor_profile();
+
+  // time into the hour, counting the current minute (or second) as done
+  int seconds = (tick_time->tm_min + 1) * SECONDS_PER_MINUTE;
+  if (power->tick_unit == SECOND_UNIT)
+    seconds = tick_time->tm_min * SECONDS_PER_MINUTE + tick_time->tm_sec + 1;
+  if (!power->animate)
+    seconds -= seconds % (POWER_SAVER_RING_MINUTES * SECONDS_PER_MINUTE);
+
+  int32_t hour_progress = PROGRESS_FRACTION(seconds, SECONDS_PER_HOUR);
+  RadialWidget *widget = radial;
+  if (!(units_changed & HOUR_UNIT) && hour_progress == widget->target)
+    return;
+
+  // a new minute sweeps the ring on; seconds, and the wrap at the hour, just move it
+  strftime(s_hour, sizeof(s_hour), "%H", tick_time);
+  if (s_face_ready && (units_changed & MINUTE_UNIT) && power->tick_unit == MINUTE_UNIT && power->animate &&
+      hour_progress > widget->target)
+    widget_radial_sweep(radial, s_hour, hour_progress, RING_SWEEP_MS);
+  else
+    widget_radial_set(radial, s_hour, hour_progress);
 }
-
-void week_layer_proc(Layer *layer, GContext *ctx)
+static void hour_digit_set(BigDigitWidget *big_digit, int number)
 {
-  time_t now = time(NULL);
-  struct tm *today = localtime(&now);
-
-  GRect bounds = layer_get_bounds(layer);
-  const int gutter = 1;
-  const int cell_width = 19;
-  const int highlight_height = 26;
+  if (s_face_ready)
+    widget_big_digit_slide(big_digit, number, DIGIT_SLIDE_MS);
+  else
+    widget_big_digit_set(big_digit, number);
+}
+static void hour_tens_tick(void *big_digit, struct tm *tick_time, TimeUnits units_changed)
+{
+  hour_digit_set(big_digit, tick_time->tm_hour / 10);
+}
+static void hour_ones_tick(void *big_digit, struct tm *tick_time, TimeUnits units_changed)
+{
+  hour_digit_set(big_digit, tick_time->tm_hour % 10);
+}
+static void date_text_tick(void *text, struct tm *tick_time, TimeUnits units_changed)
+{
+  static char s_date[16]; // "Jun  23-06-01"
+  strftime(s_date, sizeof(s_date), "%b  %y-%m-%d", tick_time);
+  widget_glyph_text_set(text, s_date);
+}
+static void battery_handler(BatteryChargeState charge_state)
+{
+  static char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%d", charge_state.charge_percent);
+  widget_radial_set(s_radial_battery, buffer, PROGRESS_FRACTION(charge_state.charge_percent, 100));
+  power_governor_update(charge_state);
+}
 
-  // month date
-  int today_month_day = today->tm_mday;                 // Get the day of the month (1-31)                // Get the month (0-11, so add 1 for 1-12)
-  int today_month_length = s_month_days[today->tm_mon]; // Get the number of days in the month
+static void hour_chime_tick(void *window, struct tm *tick_time, TimeUnits units_changed)
+{
+  // HOUR_UNIT is also set on the first tick after subscribing, at any time
+  if (tick_time->tm_min != 0 || tick_time->tm_sec != 0)
+    return;
+  if (settings_get()->hourly_chime && !quiet_time_is_active())
+    vibes_double_pulse();
+}
 
-  int today_weekday = today_month_day % 7;
-  int last_monday_weekday = today_month_day - (today_month_day + 6) % 7;
+// a look at the watch: seconds for a while
+static void tap_handler(AccelAxisType axis, int32_t direction)
+{
+  power_governor_burst(POWER_BURST_MS);
+}
 
-  // Draw line to divide weekdays from weekend (Sat Sun)
-  int x = (cell_width + gutter) * 5;
-  GPoint start = GPoint(x, 0);
-  GPoint end = GPoint(x, bounds.size.h);
-  graphics_context_set_stroke_color(ctx, GColorWhite);
-  graphics_draw_line(ctx, start, end);
+// tick resolution and ring motion for the current power profile
+static void apply_power_profile(const PowerProfile *profile)
+{
+  widget_scheduler_set_units(s_radial_minute, profile->tick_unit | MINUTE_UNIT);
+  widget_scheduler_set_units(s_calendar, profile->calendar_units);
+  widget_scheduler_subscribe();
+  transition_set_enabled(profile->animate);
+}
+static void power_profile_handler(const PowerProfile *profile)
+{
+  apply_power_profile(profile);
+  if (s_radial_minute)
+    hour_radial_tick(s_radial_minute, localtime(&(time_t){time(NULL)}), 0);
+}
 
-  for (int i = 0; i < 7; i++)
+// the light theme is the dark face under an inverting layer, kept on top
+static void apply_theme(const Settings *settings)
+{
+  Layer *window_layer = window_get_root_layer(s_main_window);
+  if (settings->theme != SETTINGS_THEME_LIGHT)
   {
-    // Calculate column position
-    int x = (i + 1) * gutter + i * cell_width;
-
-    int day_of_the_month = (last_monday_weekday + i + 1) % today_month_length;
-    int next_day_of_the_month = (last_monday_weekday + i + 7) % today_month_length + 1;
-
-    bool is_today = today_month_day == day_of_the_month;
-
-    // Draw highlight background for today
-    if (is_today)
-    {
-      graphics_context_set_fill_color(ctx, GColorWhite);
-      graphics_context_set_text_color(ctx, GColorBlack);
-      draw_highlight_box(ctx, x, cell_width, highlight_height);
-    }
-    else
+    if (s_invert)
     {
-      graphics_context_set_fill_color(ctx, GColorBlack);
-      graphics_context_set_text_color(ctx, GColorWhite);
+      layer_remove_from_parent(s_invert);
+      invert_layer_destroy(s_invert);
+      s_invert = NULL;
     }
-
-    // Draw weekday label (Su-Mo)
-    draw_day_box(ctx, x, cell_width, DAY_LETTERS[(i + 1) % 7], is_today ? s_tiny_font_bold : s_tiny_font, -3);
-
-    // Draw today’s date
-    char day_text[3];
-    snprintf(day_text, sizeof(day_text), "%d", day_of_the_month);
-    draw_day_box(ctx, x, cell_width, day_text, is_today ? s_tiny_font_bold : s_tiny_font, 10);
-
-    // Draw 6 days ahead (for visual cue?)
-    // time_t future_time = now + (i + 6) * 86400;
-    // struct tm *future_info = localtime(&future_time);
-    snprintf(day_text, sizeof(day_text), "%d", next_day_of_the_month);
-    graphics_context_set_text_color(ctx, GColorWhite);
-
-    draw_day_box(ctx, x, cell_width, day_text, s_tiny_font, 24);
+    widget_snapshot_set_inverted(s_snapshot, false);
+    return;
   }
-}
 
-// widget update handlers
-static void seconds_tick_handler(struct tm *tick_time, TimeUnits units_changed)
+  if (!s_invert)
+    s_invert = invert_layer_create(layer_get_bounds(window_layer));
+  else
+    layer_remove_from_parent(s_invert);
+  if (s_invert)
+    layer_add_child(window_layer, s_invert);
+  widget_snapshot_set_inverted(s_snapshot, s_invert != NULL);
+}
+static void apply_battery_display(const Settings *settings)
 {
-  static int prev_minute = -1;
-  static int prev_hour = -1;
-  static int prev_day = -1;
-
-  static char s_hour[3];   // 21
-  static char s_minute[3]; // 34
-  static char s_day[3];    // 01
-  static char s_date[16];  // "Jun  23-06-01"
-
-  if (prev_minute != tick_time->tm_min)
-  {
-    strftime(s_minute, sizeof(s_minute), "%M", tick_time);
-    text_layer_set_text(s_minute_layer, s_minute);
-
-    float hour_progress = (tick_time->tm_min + 1) / 60.0f;
-    widget_radial_set(s_radial_minute, s_hour, hour_progress);
-
-    prev_minute = tick_time->tm_min;
-  }
-  if (prev_hour != tick_time->tm_hour)
-  {
-    strftime(s_hour, sizeof(s_hour), "%H", tick_time);
-    prev_hour = tick_time->tm_hour;
-    widget_big_digit_set(s_big_digit_hour_tens, tick_time->tm_hour / 10);
-    widget_big_digit_set(s_big_digit_hour_ones, tick_time->tm_hour % 10);
-  }
-  if (prev_day != tick_time->tm_mday)
-  {
-    strftime(s_day, sizeof(s_day), "%d", tick_time);
-    strftime(s_date, sizeof(s_date), "%b  %y-%m-%d", tick_time);
-    text_layer_set_text(s_date_layer, s_date);
-
-    layer_mark_dirty(s_calendar_layer);
-    prev_day = tick_time->tm_mday;
-  }
+  if (s_radial_battery)
+    layer_set_hidden(s_radial_battery->layer, settings->battery == SETTINGS_BATTERY_HIDDEN);
 }
-static void battery_handler(BatteryChargeState charge_state)
+static void settings_changed(const Settings *settings, const Settings *previous)
 {
-  static char buffer[16];
-  snprintf(buffer, sizeof(buffer), "%d", charge_state.charge_percent);
-  widget_radial_set(s_radial_battery, buffer, (float)(charge_state.charge_percent) / 100.0f);
+  if (settings->theme != previous->theme)
+    apply_theme(settings);
+  apply_battery_display(settings);
+  power_governor_set_saver(settings->power == SETTINGS_POWER_SAVER);
 }
 
-// widget creation
-static void main_window_load(Window *window)
+// second startup phase: everything around the time
+static void main_window_load_rest(void *data)
 {
-  Layer *window_layer = window_get_root_layer(window);
+  s_startup_timer = NULL;
+  uint32_t start = render_timing_now();
+  Layer *window_layer = window_get_root_layer(s_main_window);
   GRect bounds = layer_get_bounds(window_layer);
 
-  s_small_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_RUBIK_18));
-  s_medium_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_RUBIK_24));
-  s_large_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_RUBIK_48));
-
   s_tiny_font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
   s_tiny_font_bold = fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD);
 
-  s_big_digit_hour_tens = widget_big_digit_create(GPoint(0, 0), 0);
-  layer_add_child(window_layer, s_big_digit_hour_tens->layer);
-  s_big_digit_hour_ones = widget_big_digit_create(GPoint(bounds.size.w - IMG_WIDTH, 0), 0);
-  layer_add_child(window_layer, s_big_digit_hour_ones->layer);
-
+  // the rings and the date go under the minute digits
   // // radial minute
   s_radial_minute = widget_radial_create(
-      GRect(0, 69, 36, 36),
+      GRect(0, IMG_HEIGHT, 36, 36),
       GColorClear, GColorWhite,
-      3, true, s_small_font, 18 * 1.3);
-  layer_add_child(window_layer, s_radial_minute->layer);
+      3, true, RESOURCE_ID_FONT_RUBIK_18, 18 * 13 / 10);
+  layer_insert_below_sibling(s_radial_minute->layer, s_minute_text->layer);
 
   // radial battery layer
   // int x = (bounds.size.w - 32) / 2;
   s_radial_battery = widget_radial_create(
-      GRect(bounds.size.w - 36, 69, 36, 36),
+      GRect(bounds.size.w - 36, IMG_HEIGHT, 36, 36),
       GColorClear,
       GColorLightGray,
       3,     // line thickness
       false, // anti-clockwise
-      s_small_font,
-      18 * 1.3 // text line_height
+      RESOURCE_ID_FONT_RUBIK_18,
+      18 * 13 / 10 // text line_height
   );
-  layer_add_child(window_layer, s_radial_battery->layer);
-
-  // date layer
-  s_date_layer = text_layer_create(
-      GRect(0, bounds.size.w - 40, bounds.size.w, 28 * 1.3));
-  text_layer_set_background_color(s_date_layer, GColorClear);
-  text_layer_set_text_color(s_date_layer, GColorWhite);
-  text_layer_set_font(s_date_layer, s_small_font);
-  text_layer_set_text_alignment(s_date_layer, GTextAlignmentCenter);
-  text_layer_set_text(s_date_layer, "June");
-  layer_add_child(window_layer, text_layer_get_layer(s_date_layer));
-
-  // minute layer
-  s_minute_layer = text_layer_create(
-      GRect((bounds.size.w - IMG_WIDTH) / 2, IMG_HEIGHT - 12, IMG_WIDTH, 48));
-  text_layer_set_background_color(s_minute_layer, GColorClear);
-  text_layer_set_text_color(s_minute_layer, GColorWhite);
-  text_layer_set_font(s_minute_layer, s_large_font);
-  text_layer_set_text_alignment(s_minute_layer, GTextAlignmentCenter);
-  text_layer_set_text(s_minute_layer, "00");
-  layer_add_child(window_layer, text_layer_get_layer(s_minute_layer));
-
-  s_calendar_layer = layer_create(
-      GRect(0, bounds.size.h - 43, bounds.size.w, 42));
-  layer_add_child(window_layer, s_calendar_layer);
-  layer_set_update_proc(s_calendar_layer, week_layer_proc);
+  layer_insert_below_sibling(s_radial_battery->layer, s_minute_text->layer);
+
+  // date line, drawn from a glyph atlas of what "%b  %y-%m-%d" can produce
+  s_date_text = widget_glyph_text_create(
+      GRect(0, bounds.size.w - 40, bounds.size.w, 28 * 13 / 10),
+      RESOURCE_ID_FONT_RUBIK_18, GColorWhite, GTextAlignmentCenter, DATE_CHARS);
+  layer_insert_below_sibling(s_date_text->layer, s_minute_text->layer);
+
+  s_calendar = widget_calendar_create(
+      GRect(0, bounds.size.h - 43, bounds.size.w, 42), s_tiny_font, s_tiny_font_bold);
+  layer_add_child(window_layer, s_calendar->layer);
+
+  // the face is complete: capture its frames instead of showing the last one
+  widget_snapshot_capture(s_snapshot, window_layer);
+  apply_theme(settings_get());
+  apply_battery_display(settings_get());
+
+  widget_scheduler_add(s_radial_minute, &RADIAL_WIDGET_CLASS, MINUTE_UNIT, hour_radial_tick);
+  widget_scheduler_add(s_radial_battery, &RADIAL_WIDGET_CLASS, 0, NULL);
+  widget_scheduler_add(s_date_text, &GLYPH_TEXT_WIDGET_CLASS, DAY_UNIT, date_text_tick);
+  widget_scheduler_add(s_calendar, &CALENDAR_WIDGET_CLASS, 0, NULL);
+  widget_scheduler_add(s_main_window, NULL, HOUR_UNIT, hour_chime_tick);
 
   // initial values
-  seconds_tick_handler(localtime(&(time_t){time(NULL)}), SECOND_UNIT);
+  apply_power_profile(power_governor_profile());
+  widget_scheduler_refresh_widget(s_radial_minute);
+  widget_scheduler_refresh_widget(s_date_text);
+  widget_scheduler_refresh_widget(s_calendar);
   battery_handler(battery_state_service_peek());
+  s_face_ready = true;
+  heap_track_load_end();
+
+  render_timing_phase("rest", start);
+  render_timing_phase("total", s_load_start);
 }
 
-// widget destruction
-static void main_window_unload(Window *window)
+// runs the second phase now if it is still pending
+static void main_window_load_finish(void)
 {
-  if (s_minute_layer)
-    text_layer_destroy(s_minute_layer);
-  if (s_date_layer)
-    text_layer_destroy(s_date_layer);
-  if (s_calendar_layer)
-    layer_destroy(s_calendar_layer);
+  if (s_startup_timer)
+  {
+    app_timer_cancel(s_startup_timer);
+    main_window_load_rest(NULL);
+  }
+}
 
-  if (s_radial_battery)
-    widget_radial_destroy(s_radial_battery);
-  if (s_radial_minute)
-    widget_radial_destroy(s_radial_minute);
-
-  if (s_small_font)
-    fonts_unload_custom_font(s_small_font);
-  if (s_medium_font)
-    fonts_unload_custom_font(s_medium_font);
-  if (s_large_font)
-    fonts_unload_custom_font(s_large_font);
-
-  if (s_big_digit_hour_tens)
-    widget_big_digit_destroy(s_big_digit_hour_tens);
-  if (s_big_digit_hour_ones)
-    widget_big_digit_destroy(s_big_digit_hour_ones);
+// first startup phase: the time, and nothing else
+static void main_window_load(Window *window)
+{
+  s_load_start = render_timing_now();
+  Layer *window_layer = window_get_root_layer(window);
+  GRect bounds = layer_get_bounds(window_layer);
+  struct tm *now = localtime(&(time_t){time(NULL)});
+  heap_track_load_begin();
+
+  // custom fonts are loaded by the widgets, on first draw
+
+  // the last frame from this minute, if there is one, until the rest is built
+  s_snapshot = widget_snapshot_create(bounds);
+  if (s_snapshot)
+    layer_add_child(window_layer, s_snapshot->layer);
+
+  // start on the current hour
+  s_big_digit_hour_tens = widget_big_digit_create(GPoint(0, 0), now->tm_hour / 10);
+  layer_add_child(window_layer, s_big_digit_hour_tens->layer);
+  s_big_digit_hour_ones = widget_big_digit_create(GPoint(bounds.size.w - IMG_WIDTH, 0), now->tm_hour % 10);
+  layer_add_child(window_layer, s_big_digit_hour_ones->layer);
+
+  // minute digits
+  s_minute_text = widget_glyph_text_create(
+      GRect((bounds.size.w - IMG_WIDTH) / 2, IMG_HEIGHT - 12, IMG_WIDTH, 48),
+      RESOURCE_ID_FONT_RUBIK_48, GColorWhite, GTextAlignmentCenter, GLYPH_TEXT_DIGITS);
+  layer_add_child(window_layer, s_minute_text->layer);
+
+  widget_scheduler_add(s_snapshot, &SNAPSHOT_WIDGET_CLASS, 0, NULL);
+  widget_scheduler_add(s_big_digit_hour_tens, &BIG_DIGIT_WIDGET_CLASS, HOUR_UNIT, hour_tens_tick);
+  widget_scheduler_add(s_big_digit_hour_ones, &BIG_DIGIT_WIDGET_CLASS, HOUR_UNIT, hour_ones_tick);
+  widget_scheduler_add(s_minute_text, &GLYPH_TEXT_WIDGET_CLASS, MINUTE_UNIT, minute_text_tick);
+
+  apply_theme(settings_get());
+
+  // initial values
+  widget_scheduler_subscribe();
+  widget_scheduler_refresh();
+
+  s_startup_timer = app_timer_register(STARTUP_DEFER_MS, main_window_load_rest, NULL);
+  render_timing_phase("first frame setup", s_load_start);
 }
 
-void hour_tick_handler(struct tm *tick_time, TimeUnits units_changed)
+// widget destruction
+static void main_window_unload(Window *window)
 {
-  if (!quiet_time_is_active())
+  if (s_startup_timer)
   {
-    vibes_double_pulse();
+    app_timer_cancel(s_startup_timer);
+    s_startup_timer = NULL;
+  }
+  s_face_ready = false;
+  widget_scheduler_destroy_all();
+  s_radial_minute = NULL;
+  s_radial_battery = NULL;
+  s_date_text = NULL;
+  s_calendar = NULL;
+  s_snapshot = NULL;
+  if (s_invert)
+  {
+    layer_remove_from_parent(s_invert);
+    invert_layer_destroy(s_invert);
+    s_invert = NULL;
   }
+  heap_track_unload_end();
 }
 
 static void init()
 {
+  // settings are on the watch: nothing to wait for before the first frame
+  const Settings *settings = settings_load();
+  power_governor_set_saver(settings->power == SETTINGS_POWER_SAVER);
+  power_governor_init(battery_state_service_peek(), power_profile_handler);
+
   s_main_window = window_create();
   window_set_background_color(s_main_window, GColorBlack);
   window_set_window_handlers(s_main_window, (WindowHandlers){
                                                 .load = main_window_load,
                                                 .unload = main_window_unload});
+#if defined(WIDGET_HEAP_TRACKING)
+  // cycle the window so leaks are reported before the face starts
+  for (int i = 0; i < HEAP_TRACK_LEAK_CYCLES; i++)
+  {
+    window_stack_push(s_main_window, false);
+    main_window_load_finish();
+    window_stack_pop(false);
+  }
+#endif
   window_stack_push(s_main_window, true);
 
-  tick_timer_service_subscribe(MINUTE_UNIT, seconds_tick_handler);
   battery_state_service_subscribe(battery_handler);
+  accel_tap_service_subscribe(tap_handler);
+  settings_listen(settings_changed);
 }
 
 static void deinit()
 {
+  settings_deinit();
+  accel_tap_service_unsubscribe();
+  power_governor_deinit();
   window_destroy(s_main_window);
 }
 
@@ -275,4 +358,5 @@ int main(void)
   init();
   app_event_loop();
   deinit();
+  return 0;
 }
\ No newline at end of file
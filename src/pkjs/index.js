@@ -0,0 +1,65 @@
+// Settings page for the face: a data: URL page that returns its choices to
+// webviewclosed, which sends them to the watch (src/c/modules/settings.h).
+// Values are the watch's enum values; the last ones sent are kept so the
+// page opens on them.
+var keys = require('message_keys');
+
+var FIELDS = [
+  {key: 'THEME', label: 'Theme', options: ['Dark', 'Light']},
+  {key: 'HOURLY_CHIME', label: 'Hourly chime', options: ['Off', 'On']},
+  {key: 'BATTERY', label: 'Battery', options: ['Ring', 'Hidden']},
+  {key: 'POWER', label: 'Power', options: ['Follow the battery', 'Always save']}
+];
+
+function loadSettings() {
+  try {
+    return JSON.parse(localStorage.getItem('settings')) || {};
+  } catch (e) {
+    return {};
+  }
+}
+
+function settingsPage(settings) {
+  var html = '<!DOCTYPE html><html><head><meta name="viewport" content="width=device-width">' +
+    '<style>body{font-family:sans-serif;margin:16px}label{display:block;margin:12px 0}' +
+    'select,button{width:100%;font-size:16px;padding:8px}</style></head><body><h2>Dials</h2>';
+  FIELDS.forEach(function(field) {
+    html += '<label>' + field.label + '<select id="' + field.key + '">';
+    field.options.forEach(function(option, value) {
+      html += '<option value="' + value + '"' + (settings[field.key] === value ? ' selected' : '') + '>' +
+        option + '</option>';
+    });
+    html += '</select></label>';
+  });
+  html += '<button onclick="save()">Save</button><script>function save(){var s={};' +
+    JSON.stringify(FIELDS.map(function(field) { return field.key; })) +
+    '.forEach(function(k){s[k]=parseInt(document.getElementById(k).value,10);});' +
+    'location.href="pebblejs://close#"+encodeURIComponent(JSON.stringify(s));}</script></body></html>';
+  return 'data:text/html;charset=utf-8,' + encodeURIComponent(html);
+}
+
+Pebble.addEventListener('showConfiguration', function() {
+  Pebble.openURL(settingsPage(loadSettings()));
+});
+
+Pebble.addEventListener('webviewclosed', function(e) {
+  if (!e.response) return;
+  var settings;
+  try {
+    settings = JSON.parse(decodeURIComponent(e.response));
+  } catch (err) {
+    return;
+  }
+
+  var message = {};
+  FIELDS.forEach(function(field) {
+    var value = settings[field.key];
+    if (typeof value === 'number' && value >= 0 && value < field.options.length) {
+      message[keys[field.key]] = value;
+    }
+  });
+  localStorage.setItem('settings', JSON.stringify(settings));
+  Pebble.sendAppMessage(message, null, function() {
+    console.log('settings: not delivered');
+  });
+});
@@ -0,0 +1,398 @@
+#!/usr/bin/env python3
+"""Render the big digits from the face's TTF into one 1-bit atlas per platform.
+
+Each platform gets its own digit size, scaled from the 69 px digits of the
+144 px wide displays, so emery and chalk get digits sized for their screens.
+The ten glyphs are cropped to their ink and stacked in a single column, and a
+generated header records where each one sits in the atlas and where it goes in
+its digit cell. BigDigitWidget loads the atlas once and draws digits as
+sub-bitmap views of it.
+
+Outputs, for every platform:
+
+    resources/generated/digit_atlas~<platform>.bin    the atlas resource
+    src/c/generated/digit_atlas.h                     cell size and glyph rects
+
+The untagged digit_atlas.bin is a copy of the aplite atlas for tools that
+don't resolve platform tags.
+
+Atlas layout (little endian):
+
+    offset  size    field
+    0       2       magic "DA"
+    2       1       version (1)
+    3       1       flags (bit 0: rows are RLE-compressed)
+    4       2       atlas width in pixels
+    6       2       atlas height in pixels
+    8       2       bytes per row, ceil(width / 8)
+    10      ...     rows
+
+Rows are 1 bit per pixel, least significant bit first (Pebble's 1-bit
+framebuffer order), 1 = white. RLE data is PackBits over all rows: a control
+byte n < 128 is followed by n+1 literal bytes, n >= 128 by one byte repeated
+257-n times.
+
+The TrueType outlines are read and rasterized here with the standard library
+only, so the same script runs from wscript and from the host Makefile.
+"""
+import os
+import shutil
+import struct
+import sys
+
+MAGIC = b'DA'
+VERSION = 1
+FLAG_RLE = 1
+HEADER_SIZE = 10
+FONT = 'rubik-semi-bold.ttf'
+
+# Digit cell size per platform: 69 px on the 144 px wide displays, scaled with
+# the display width elsewhere.
+PLATFORMS = [
+    ('aplite', 69),
+    ('basalt', 69),
+    ('chalk', 86),
+    ('diorite', 69),
+    ('emery', 96),
+]
+
+SUBSAMPLES = 4  # scanlines per pixel row when computing coverage
+CURVE_STEPS = 8  # line segments per quadratic curve
+
+
+# font -------------------------------------------------------------------------
+
+class Font(object):
+    """The subset of a TrueType (glyf) font needed to draw the digits."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        count = struct.unpack('>H', data[4:6])[0]
+        self.tables = {}
+        for i in range(count):
+            tag, _, offset, length = struct.unpack('>4sIII', data[12 + 16 * i:28 + 16 * i])
+            self.tables[tag.decode('latin-1')] = data[offset:offset + length]
+        if 'glyf' not in self.tables:
+            raise ValueError('{}: only TrueType outlines are supported'.format(path))
+        self.long_loca = struct.unpack('>h', self.tables['head'][50:52])[0] == 1
+        self.cmap = self._find_cmap()
+
+    def _find_cmap(self):
+        cmap = self.tables['cmap']
+        for i in range(struct.unpack('>H', cmap[2:4])[0]):
+            platform, encoding, offset = struct.unpack('>HHI', cmap[4 + 8 * i:12 + 8 * i])
+            if (platform, encoding) in ((3, 1), (0, 3)) and cmap[offset:offset + 2] == b'\x00\x04':
+                return cmap[offset:]
+        raise ValueError('no Unicode BMP cmap')
+
+    def glyph_index(self, char):
+        table = self.cmap
+        code = ord(char)
+        segments = struct.unpack('>H', table[6:8])[0] // 2
+
+        def field(array, i):
+            # endCode, startCode, idDelta and idRangeOffset arrays, in that
+            # order, with a reserved word after endCode
+            pos = 14 + 2 * segments * array + (2 if array else 0) + 2 * i
+            return struct.unpack('>H', table[pos:pos + 2])[0]
+
+        for i in range(segments):
+            if code > field(0, i):
+                continue
+            start = field(1, i)
+            if code < start:
+                break
+            delta = field(2, i)
+            range_offset = field(3, i)
+            if not range_offset:
+                return (code + delta) & 0xFFFF
+            pos = 16 + 6 * segments + 2 * i + range_offset + 2 * (code - start)
+            index = struct.unpack('>H', table[pos:pos + 2])[0]
+            return (index + delta) & 0xFFFF if index else 0
+        return 0
+
+    def _glyph_data(self, index):
+        loca = self.tables['loca']
+        if self.long_loca:
+            start, end = struct.unpack('>II', loca[4 * index:4 * index + 8])
+        else:
+            start, end = [2 * v for v in struct.unpack('>HH', loca[2 * index:2 * index + 4])]
+        return self.tables['glyf'][start:end]
+
+    def contours(self, index):
+        """Outline of a glyph as closed polylines in font units."""
+        data = self._glyph_data(index)
+        if not data:
+            return []
+        count = struct.unpack('>h', data[0:2])[0]
+        if count < 0:
+            return self._composite_contours(data)
+
+        end_points = struct.unpack('>{}H'.format(count), data[10:10 + 2 * count])
+        pos = 10 + 2 * count
+        pos += 2 + struct.unpack('>H', data[pos:pos + 2])[0]
+        total = end_points[-1] + 1 if count else 0
+
+        flags = []
+        while len(flags) < total:
+            flag = data[pos]
+            pos += 1
+            flags.append(flag)
+            if flag & 8:
+                flags.extend([flag] * data[pos])
+                pos += 1
+
+        def coords(short_bit, same_bit):
+            nonlocal pos
+            values, value = [], 0
+            for flag in flags:
+                if flag & short_bit:
+                    value += data[pos] if flag & same_bit else -data[pos]
+                    pos += 1
+                elif not flag & same_bit:
+                    value += struct.unpack('>h', data[pos:pos + 2])[0]
+                    pos += 2
+                values.append(value)
+            return values
+
+        xs = coords(2, 16)
+        ys = coords(4, 32)
+
+        contours, first = [], 0
+        for last in end_points:
+            points = [(xs[i], ys[i], flags[i] & 1) for i in range(first, last + 1)]
+            contours.append(flatten(points))
+            first = last + 1
+        return contours
+
+    def _composite_contours(self, data):
+        contours, pos = [], 10
+        while True:
+            flags, index = struct.unpack('>HH', data[pos:pos + 4])
+            pos += 4
+            if flags & 1:
+                dx, dy = struct.unpack('>hh', data[pos:pos + 4])
+                pos += 4
+            else:
+                dx, dy = struct.unpack('>bb', data[pos:pos + 2])
+                pos += 2
+            a, b, c, d = 1.0, 0.0, 0.0, 1.0
+            if flags & 0x08:
+                a = d = struct.unpack('>h', data[pos:pos + 2])[0] / 16384.0
+                pos += 2
+            elif flags & 0x40:
+                a, d = [v / 16384.0 for v in struct.unpack('>hh', data[pos:pos + 4])]
+                pos += 4
+            elif flags & 0x80:
+                a, b, c, d = [v / 16384.0 for v in struct.unpack('>hhhh', data[pos:pos + 8])]
+                pos += 8
+            for contour in self.contours(index):
+                contours.append([(a * x + c * y + dx, b * x + d * y + dy) for x, y in contour])
+            if not flags & 0x20:
+                return contours
+
+    def bounds(self, index):
+        data = self._glyph_data(index)
+        return struct.unpack('>hhhh', data[2:10]) if data else (0, 0, 0, 0)
+
+
+def flatten(points):
+    """Turn one TrueType contour of on/off-curve points into a polyline."""
+    # Consecutive off-curve points imply an on-curve point between them.
+    expanded = []
+    for i, (x, y, on) in enumerate(points):
+        px, py, pon = points[i - 1]
+        if not on and not pon:
+            expanded.append(((px + x) / 2.0, (py + y) / 2.0, 1))
+        expanded.append((x, y, on))
+    start = next(i for i, p in enumerate(expanded) if p[2])
+    expanded = expanded[start:] + expanded[:start]
+
+    line = [expanded[0][:2]]
+    i, n = 1, len(expanded)
+    while i <= n:
+        x, y, on = expanded[i % n]
+        if on:
+            line.append((x, y))
+            i += 1
+            continue
+        x0, y0 = line[-1]
+        x2, y2 = expanded[(i + 1) % n][:2]
+        for step in range(1, CURVE_STEPS + 1):
+            t = step / float(CURVE_STEPS)
+            u = 1 - t
+            line.append((u * u * x0 + 2 * u * t * x + t * t * x2, u * u * y0 + 2 * u * t * y + t * t * y2))
+        i += 2
+    return line
+
+
+# rasterizer -------------------------------------------------------------------
+
+def rasterize(contours, width, height):
+    """Fill polylines (in pixel coordinates, y down) with the nonzero rule.
+
+    Returns rows of booleans; a pixel is set when at least half of it is covered.
+    """
+    rows = [[] for _ in range(height)]
+    for contour in contours:
+        for (x0, y0), (x1, y1) in zip(contour, contour[1:] + contour[:1]):
+            if y0 == y1:
+                continue
+            top, bottom = max(int(min(y0, y1)), 0), min(int(max(y0, y1)), height - 1)
+            for row in range(top, bottom + 1):
+                rows[row].append((x0, y0, x1, y1))
+
+    pixels = []
+    for row, edges in enumerate(rows):
+        coverage = [0.0] * width
+        for sub in range(SUBSAMPLES):
+            sy = row + (sub + 0.5) / SUBSAMPLES
+            crossings = []
+            for x0, y0, x1, y1 in edges:
+                if y0 <= sy < y1 or y1 <= sy < y0:
+                    crossings.append((x0 + (sy - y0) * (x1 - x0) / (y1 - y0), 1 if y1 > y0 else -1))
+            crossings.sort()
+            winding, span_start = 0, 0.0
+            for x, direction in crossings:
+                if not winding:
+                    span_start = x
+                winding += direction
+                if not winding:
+                    add_span(coverage, span_start, x, 1.0 / SUBSAMPLES)
+        pixels.append([c >= 0.5 for c in coverage])
+    return pixels
+
+
+def add_span(coverage, x0, x1, weight):
+    x0, x1 = max(x0, 0.0), min(x1, float(len(coverage)))
+    px = int(x0)
+    while px < x1:
+        coverage[px] += (min(x1, px + 1) - max(x0, px)) * weight
+        px += 1
+
+
+def render_digits(font, cell):
+    """Each digit in a cell x cell box: digits share one baseline and scale,
+    fill the cell's height between them, and are centered horizontally."""
+    indices = [font.glyph_index(str(n)) for n in range(10)]
+    bounds = [font.bounds(i) for i in indices]
+    y_min = min(b[1] for b in bounds)
+    y_max = max(b[3] for b in bounds)
+    scale = cell / float(y_max - y_min)
+
+    digits = []
+    for index, (x_min, _, x_max, _) in zip(indices, bounds):
+        x_offset = cell / 2.0 - (x_min + x_max) / 2.0 * scale
+        contours = [[(x * scale + x_offset, (y_max - y) * scale) for x, y in contour]
+                    for contour in font.contours(index)]
+        digits.append(rasterize(contours, cell, cell))
+    return digits
+
+
+# atlas ------------------------------------------------------------------------
+
+def crop(pixels):
+    """Ink bounds of a glyph as (x, y, w, h)."""
+    ys = [y for y, row in enumerate(pixels) if any(row)]
+    xs = [x for row in pixels for x, on in enumerate(row) if on]
+    if not ys:
+        return 0, 0, 0, 0
+    return min(xs), ys[0], max(xs) - min(xs) + 1, ys[-1] - ys[0] + 1
+
+
+def build_atlas(digits):
+    """Stack the cropped glyphs in one column, each starting at x = 0."""
+    crops = [crop(d) for d in digits]
+    width = max(c[2] for c in crops)
+    row_bytes = (width + 7) // 8
+
+    rects, rows, y = [], bytearray(), 0
+    for pixels, (cx, cy, cw, ch) in zip(digits, crops):
+        rects.append(((0, y, cw, ch), (cx, cy)))
+        for line in pixels[cy:cy + ch]:
+            packed = bytearray(row_bytes)
+            for x, on in enumerate(line[cx:cx + cw]):
+                if on:
+                    packed[x // 8] |= 1 << (x % 8)
+            rows += packed
+        y += ch
+    return (width, y, row_bytes), rects, bytes(rows)
+
+
+def packbits(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run > 1:
+            out += bytes((257 - run, data[i]))
+            i += run
+            continue
+        start = i
+        while i < len(data) and i - start < 128 and (i + 1 >= len(data) or data[i + 1] != data[i]):
+            i += 1
+        out.append(i - start - 1)
+        out += data[start:i]
+    return bytes(out)
+
+
+def atlas_resource(size, rows, rle=True):
+    width, height, row_bytes = size
+    header = MAGIC + struct.pack('<BBHHH', VERSION, FLAG_RLE if rle else 0, width, height, row_bytes)
+    return header + (packbits(rows) if rle else rows)
+
+
+def atlas_header(platforms):
+    out = ['// Generated by tools/digit_atlas.py from resources/{}, do not edit.'.format(FONT),
+           '#pragma once', '']
+    for i, (platform, cell, size, rects) in enumerate(platforms):
+        out.append('#{} defined(PBL_PLATFORM_{})'.format('if' if i == 0 else 'elif', platform.upper()))
+        out.append('#define DIGIT_CELL_SIZE {}'.format(cell))
+        out.append('#define DIGIT_ATLAS_WIDTH {}'.format(size[0]))
+        out.append('#define DIGIT_ATLAS_HEIGHT {}'.format(size[1]))
+        out.append('// {atlas rect, position in the cell} per digit')
+        out.append('#define DIGIT_ATLAS_GLYPHS { \\')
+        for (x, y, w, h), (cx, cy) in rects:
+            out.append('    {{{{{{{}, {}}}, {{{}, {}}}}}, {{{}, {}}}}}, \\'.format(x, y, w, h, cx, cy))
+        out.append('}')
+    out += ['#else', '#error "digit_atlas.h: unknown platform"', '#endif', '']
+    return '\n'.join(out)
+
+
+def generate(resources_dir, header_path, rle=True):
+    font_path = os.path.join(resources_dir, FONT)
+    out_dir = os.path.join(resources_dir, 'generated')
+    outputs = [header_path, os.path.join(out_dir, 'digit_atlas.bin')]
+    outputs += [os.path.join(out_dir, 'digit_atlas~{}.bin'.format(p)) for p, _ in PLATFORMS]
+    newest_input = max(os.path.getmtime(font_path), os.path.getmtime(__file__))
+    if all(os.path.exists(p) and os.path.getmtime(p) >= newest_input for p in outputs):
+        return
+
+    font = Font(font_path)
+    rendered = {}
+    platforms = []
+    for platform, cell in PLATFORMS:
+        if cell not in rendered:
+            rendered[cell] = build_atlas(render_digits(font, cell))
+        size, rects, rows = rendered[cell]
+        platforms.append((platform, cell, size, rects))
+
+        os.makedirs(out_dir, exist_ok=True)
+        with open(os.path.join(out_dir, 'digit_atlas~{}.bin'.format(platform)), 'wb') as f:
+            f.write(atlas_resource(size, rows, rle))
+
+    shutil.copyfile(os.path.join(out_dir, 'digit_atlas~{}.bin'.format(PLATFORMS[0][0])),
+                    os.path.join(out_dir, 'digit_atlas.bin'))
+    os.makedirs(os.path.dirname(header_path), exist_ok=True)
+    with open(header_path, 'w') as f:
+        f.write(atlas_header(platforms))
+
+
+if __name__ == '__main__':
+    args = [a for a in sys.argv[1:] if a != '--raw']
+    if len(args) != 2:
+        sys.exit('usage: digit_atlas.py [--raw] <resources-dir> <header>')
+    generate(args[0], args[1], rle='--raw' not in sys.argv)
@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+"""Screenshot regression and render timing suite, run in the SDK emulator.
+
+For every platform in package.json's targetPlatforms (or --platforms) the
+face, built with update proc timing in (`pebble build -- --render-timing`),
+is installed in a fresh QEMU emulator and taken through a matrix of battery
+levels and times. The emulator is screenshotted at each point and the
+screenshot compared with the golden image for it, and the face's own
+render_timing log lines are collected and compared with the timing baseline.
+
+Nothing in the matrix puts the face on second ticks (charging, a tap burst):
+its frames would depend on when the screenshot lands. Times are set a few
+seconds past the minute for the same reason.
+
+Inputs:
+
+    tools/emu_golden/<platform>/<case>.png    golden screenshots
+    tools/emu_golden/timing.json              per-platform timing baseline
+
+Outputs, under build/emu/:
+
+    <platform>/<case>.png         the screenshot
+    <platform>/<case>.diff.png    changed pixels in red, for failed cases
+    <platform>/logs.txt           the app log of the whole run
+    report.txt                    what failed, and the timings
+
+`--update` records the screenshots and timings of the run as the new goldens
+and baseline instead of comparing. Exits non-zero when anything failed.
+
+PNGs are read and written here with the standard library only, like the other
+scripts in tools/.
+"""
+import argparse
+import json
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import time
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+GOLDEN_DIR = os.path.join(ROOT, 'tools', 'emu_golden')
+OUT_DIR = os.path.join(ROOT, 'build', 'emu')
+
+# Battery levels: normal, and the power saver (POWER_SAVER_PERCENT is 20).
+# Going from the saver back up would need POWER_SAVER_EXIT_PERCENT, so the
+# levels only go down.
+BATTERY_LEVELS = [100, 55, 15]
+
+# UTC times: midnight, a full ring before the hour, mid-hour on a month
+# boundary in the calendar strip, and a year boundary.
+TIMES = [
+    ('0000', '2026-03-30T00:00:05'),
+    ('1159', '2026-03-31T11:59:05'),
+    ('1234', '2026-03-31T12:34:05'),
+    ('2359', '2026-12-31T23:59:05'),
+]
+
+# Long enough for the deferred startup phase, a digit slide or a ring sweep.
+SETTLE_S = 2.0
+
+# A proc's timing regresses when its average or maximum exceeds the baseline
+# by this fraction plus TIMING_SLACK_MS (time_ms() counts whole milliseconds).
+TIMING_TOLERANCE = 0.25
+TIMING_SLACK_MS = 2
+
+RENDER_LINE = re.compile(r'render (\w+): (\d+) calls, last (\d+): min (\d+) avg (\d+) max (\d+) ms')
+STARTUP_LINE = re.compile(r'startup ([\w ]+): (\d+) ms')
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+
+
+# png ----------------------------------------------------------------------------
+
+
+def read_png(path):
+    """Returns (width, height, rows of (r, g, b) tuples) of an 8-bit RGB(A) PNG."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError('{}: not a PNG'.format(path))
+
+    pos, idat, header = 8, b'', None
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if kind == b'IHDR':
+            header = struct.unpack('>IIBBBBB', body)
+        elif kind == b'IDAT':
+            idat += body
+        pos += 12 + length
+
+    width, height, depth, color, _, _, interlace = header
+    if depth != 8 or color not in (2, 6) or interlace:
+        raise ValueError('{}: only 8-bit non-interlaced RGB(A) is supported'.format(path))
+    bpp = 3 if color == 2 else 4
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+
+    rows, above = [], bytearray(stride)
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            left = line[i - bpp] if i >= bpp else 0
+            up = above[i]
+            up_left = above[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xff
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xff
+            elif kind == 3:
+                line[i] = (line[i] + (left + up) // 2) & 0xff
+            elif kind == 4:
+                p = left + up - up_left
+                pa, pb, pc = abs(p - left), abs(p - up), abs(p - up_left)
+                predictor = left if pa <= pb and pa <= pc else up if pb <= pc else up_left
+                line[i] = (line[i] + predictor) & 0xff
+        rows.append([tuple(line[x * bpp:x * bpp + 3]) for x in range(width)])
+        above = line
+    return width, height, rows
+
+
+def write_png(path, width, height, rows):
+    def chunk(kind, body):
+        return struct.pack('>I', len(body)) + kind + body + struct.pack('>I', zlib.crc32(kind + body))
+
+    raw = b''.join(b'\x00' + bytes(c for pixel in row for c in pixel) for row in rows)
+    with open(path, 'wb') as f:
+        f.write(PNG_SIGNATURE)
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 2, 0, 0, 0)))
+        f.write(chunk(b'IDAT', zlib.compress(raw, 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def compare_png(shot_path, golden_path, diff_path):
+    """Returns the number of differing pixels; writes a diff image if any."""
+    width, height, shot = read_png(shot_path)
+    golden_width, golden_height, golden = read_png(golden_path)
+    if (width, height) != (golden_width, golden_height):
+        return width * height
+
+    changed = 0
+    diff = []
+    for shot_row, golden_row in zip(shot, golden):
+        row = []
+        for a, b in zip(shot_row, golden_row):
+            if a != b:
+                changed += 1
+                row.append((255, 0, 0))
+            else:
+                row.append(tuple(c // 3 for c in b))
+        diff.append(row)
+    if changed:
+        write_png(diff_path, width, height, diff)
+    return changed
+
+
+# emulator -----------------------------------------------------------------------
+
+
+def pebble(*args, check=True):
+    return subprocess.run(['pebble'] + list(args), cwd=ROOT, check=check,
+                          stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+
+
+def target_platforms():
+    with open(os.path.join(ROOT, 'package.json')) as f:
+        return json.load(f)['pebble']['targetPlatforms']
+
+
+def run_platform(platform, out_dir):
+    """Takes the face through the matrix; returns {case: screenshot path} and its log."""
+    os.makedirs(out_dir, exist_ok=True)
+    pebble('install', '--emulator', platform)
+    log_path = os.path.join(out_dir, 'logs.txt')
+    with open(log_path, 'w') as log:
+        logs = subprocess.Popen(['pebble', 'logs', '--emulator', platform], cwd=ROOT,
+                                stdout=log, stderr=subprocess.STDOUT)
+        try:
+            shots = {}
+            for percent in BATTERY_LEVELS:
+                pebble('emu-battery', '--emulator', platform, '--percent', str(percent))
+                for name, when in TIMES:
+                    pebble('emu-set-time', '--emulator', platform, '--utc', when)
+                    time.sleep(SETTLE_S)
+                    case = 'battery{}_{}'.format(percent, name)
+                    shots[case] = os.path.join(out_dir, case + '.png')
+                    pebble('screenshot', '--emulator', platform, '--no-open', '--no-correction', shots[case])
+            # the last frames' timings are logged on the next draw a minute on
+            pebble('emu-set-time', '--emulator', platform, '--utc', TIMES[0][1])
+            time.sleep(SETTLE_S)
+        finally:
+            logs.terminate()
+            logs.wait()
+    with open(log_path) as f:
+        return shots, f.read()
+
+
+# timing -------------------------------------------------------------------------
+
+
+def parse_timing(log):
+    """Worst average and maximum per update proc, and the slowest startup phases."""
+    render, startup = {}, {}
+    for match in RENDER_LINE.finditer(log):
+        name, avg, worst = match.group(1), int(match.group(5)), int(match.group(6))
+        entry = render.setdefault(name, {'avg': 0, 'max': 0})
+        entry['avg'] = max(entry['avg'], avg)
+        entry['max'] = max(entry['max'], worst)
+    for match in STARTUP_LINE.finditer(log):
+        phase = match.group(1)
+        startup[phase] = max(startup.get(phase, 0), int(match.group(2)))
+    return {'render': render, 'startup': startup}
+
+
+def timing_regressions(timing, baseline):
+    def over(value, limit):
+        return value > limit * (1 + TIMING_TOLERANCE) + TIMING_SLACK_MS
+
+    failures = []
+    for name, entry in sorted(timing['render'].items()):
+        base = baseline.get('render', {}).get(name)
+        for key in ('avg', 'max'):
+            if base and over(entry[key], base[key]):
+                failures.append('{} {} {} ms, baseline {} ms'.format(name, key, entry[key], base[key]))
+    for phase, ms in sorted(timing['startup'].items()):
+        base = baseline.get('startup', {}).get(phase)
+        if base is not None and over(ms, base):
+            failures.append('startup {} {} ms, baseline {} ms'.format(phase, ms, base))
+    return failures
+
+
+def format_timing(timing):
+    lines = ['  {:<32} {:>6} {:>6}'.format('proc', 'avg', 'max')]
+    for name, entry in sorted(timing['render'].items()):
+        lines.append('  {:<32} {:>6} {:>6}'.format(name, entry['avg'], entry['max']))
+    for phase, ms in sorted(timing['startup'].items()):
+        lines.append('  startup {:<24} {:>6}'.format(phase, ms))
+    return lines
+
+
+# main ---------------------------------------------------------------------------
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--platforms', help='comma-separated, default: targetPlatforms from package.json')
+    parser.add_argument('--update', action='store_true', help='record goldens and timing baseline')
+    parser.add_argument('--skip-build', action='store_true', help='use the existing build/*.pbw')
+    parser.add_argument('--tolerance', type=int, default=0, help='differing pixels allowed per screenshot')
+    args = parser.parse_args()
+
+    platforms = args.platforms.split(',') if args.platforms else target_platforms()
+    if not args.skip_build:
+        pebble('build', '--', '--render-timing')
+
+    baseline_path = os.path.join(GOLDEN_DIR, 'timing.json')
+    baseline = {}
+    if os.path.exists(baseline_path):
+        with open(baseline_path) as f:
+            baseline = json.load(f)
+
+    # a persisted snapshot or settings from an earlier run would change the first frames
+    pebble('kill', check=False)
+    pebble('wipe', check=False)
+
+    report, failures, timings = [], [], {}
+    for platform in platforms:
+        out_dir = os.path.join(OUT_DIR, platform)
+        shots, log = run_platform(platform, out_dir)
+        pebble('kill', check=False)
+        timings[platform] = parse_timing(log)
+
+        report.append('== {} =='.format(platform))
+        for case, shot in sorted(shots.items()):
+            golden = os.path.join(GOLDEN_DIR, platform, case + '.png')
+            if args.update:
+                os.makedirs(os.path.dirname(golden), exist_ok=True)
+                shutil.copyfile(shot, golden)
+                continue
+            if not os.path.exists(golden):
+                failures.append('{} {}: no golden image'.format(platform, case))
+                continue
+            changed = compare_png(shot, golden, os.path.join(out_dir, case + '.diff.png'))
+            if changed > args.tolerance:
+                failures.append('{} {}: {} pixels differ'.format(platform, case, changed))
+
+        report += format_timing(timings[platform])
+        if not args.update:
+            failures += ['{} {}'.format(platform, f)
+                         for f in timing_regressions(timings[platform], baseline.get(platform, {}))]
+        report.append('')
+
+    if args.update:
+        baseline.update(timings)
+        os.makedirs(GOLDEN_DIR, exist_ok=True)
+        with open(baseline_path, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write('\n')
+
+    report += ['{} failures'.format(len(failures))] + failures
+    os.makedirs(OUT_DIR, exist_ok=True)
+    with open(os.path.join(OUT_DIR, 'report.txt'), 'w') as f:
+        f.write('\n'.join(report) + '\n')
+    print('\n'.join(report))
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
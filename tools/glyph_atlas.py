@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Render each custom font's characters into a 1-bit glyph atlas resource.
+
+GlyphTextWidget draws its labels from these atlases instead of rendering the
+characters with graphics_draw_text on the watch. Every font resource in
+package.json gets one atlas. It holds the characters its characterRegex keeps,
+or printable ASCII without one, at the pixel size that ends the resource name
+(FONT_RUBIK_18 is 18 px to the em). The atlas for FONT_<NAME> is the raw
+resource GLYPHS_<NAME>, which package.json must declare. A generated header
+pairs the two resource ids.
+
+Outputs:
+
+    resources/generated/glyphs_<name>.bin    the atlas resource, one per font
+    src/c/generated/glyph_atlas.h            {font, atlas} resource id pairs
+
+Atlas layout:
+
+    offset  size        field
+    0       2           magic "GA"
+    2       1           version (1)
+    3       1           glyph count
+    4       6 * count   glyphs: char, advance, x, y (signed), w, h
+    ...                 each glyph's rows, in glyph order
+
+A glyph's x is its ink's left edge relative to the pen position, and y the
+top of its ink below the top of the line, whose baseline is at the font's
+ascender. Rows are (w + 7) / 8 bytes, 1 bit per pixel, least significant bit
+first, 1 = ink.
+
+Outlines are read and rasterized with tools/digit_atlas.py, so this also
+runs from wscript and from the host Makefile with the standard library only.
+"""
+import json
+import math
+import os
+import re
+import struct
+import sys
+
+import digit_atlas
+
+MAGIC = b'GA'
+VERSION = 1
+RECORD_SIZE = 6
+
+
+def fonts(package_json):
+    """(name, file, size, chars) for every font resource."""
+    with open(package_json) as f:
+        media = json.load(f)['pebble']['resources']['media']
+    out = []
+    for entry in media:
+        if entry['type'] != 'font':
+            continue
+        size = re.search(r'(\d+)$', entry['name'])
+        if not size:
+            raise ValueError('{}: font resource names end in their pixel size'.format(entry['name']))
+        pattern = re.compile(entry.get('characterRegex', '[ -~]'))
+        chars = ''.join(c for c in map(chr, range(0x20, 0x7f)) if pattern.fullmatch(c))
+        out.append((entry['name'][len('FONT_'):], entry['file'], int(size.group(1)), chars))
+    return out
+
+
+def render_glyph(font, char, size):
+    """(advance, x, y, w, h, rows) of one character at `size` px to the em."""
+    upem = struct.unpack('>H', font.tables['head'][18:20])[0]
+    ascender, descender = struct.unpack('>hh', font.tables['hhea'][4:8])
+    metrics = struct.unpack('>H', font.tables['hhea'][34:36])[0]
+    scale = size / float(upem)
+
+    index = font.glyph_index(char)
+    hmtx = font.tables['hmtx']
+    advance = struct.unpack('>H', hmtx[4 * min(index, metrics - 1):][:2])[0]
+    advance = int(round(advance * scale))
+
+    contours = font.contours(index)
+    if not contours:
+        return advance, 0, 0, 0, 0, []
+    x_min, _, x_max, _ = font.bounds(index)
+    left = int(math.floor(x_min * scale))
+    width = int(math.ceil(x_max * scale)) - left + 1
+    height = int(math.ceil((ascender - descender) * scale)) + 1
+    contours = [[(x * scale - left, (ascender - y) * scale) for x, y in contour] for contour in contours]
+    pixels = digit_atlas.rasterize(contours, width, height)
+
+    cx, cy, cw, ch = digit_atlas.crop(pixels)
+    rows = []
+    for line in pixels[cy:cy + ch]:
+        packed = bytearray((cw + 7) // 8)
+        for x, on in enumerate(line[cx:cx + cw]):
+            if on:
+                packed[x // 8] |= 1 << (x % 8)
+        rows.append(bytes(packed))
+    return advance, left + cx, cy, cw, ch, rows
+
+
+def atlas_resource(font, size, chars):
+    records, bits = bytearray(), bytearray()
+    for char in chars:
+        advance, x, y, w, h, rows = render_glyph(font, char, size)
+        records += struct.pack('<cBbbBB', char.encode('ascii'), advance, x, y, w, h)
+        for row in rows:
+            bits += row
+    return MAGIC + struct.pack('<BB', VERSION, len(chars)) + bytes(records) + bytes(bits)
+
+
+def atlas_header(names):
+    out = ['// Generated by tools/glyph_atlas.py from package.json, do not edit.', '#pragma once', '',
+           '// {font resource, its glyph atlas resource} per custom font',
+           '#define GLYPH_ATLAS_FONTS { \\']
+    for name in names:
+        out.append('    {{RESOURCE_ID_FONT_{0}, RESOURCE_ID_GLYPHS_{0}}}, \\'.format(name))
+    out += ['}', '']
+    return '\n'.join(out)
+
+
+def generate(package_json, resources_dir, header_path):
+    entries = fonts(package_json)
+    out_dir = os.path.join(resources_dir, 'generated')
+    outputs = [header_path] + [os.path.join(out_dir, 'glyphs_{}.bin'.format(e[0].lower())) for e in entries]
+    inputs = [package_json, __file__, digit_atlas.__file__] + [os.path.join(resources_dir, e[1]) for e in entries]
+    newest_input = max(os.path.getmtime(p) for p in inputs)
+    if all(os.path.exists(p) and os.path.getmtime(p) >= newest_input for p in outputs):
+        return
+
+    loaded = {}
+    os.makedirs(out_dir, exist_ok=True)
+    for (name, path, size, chars), output in zip(entries, outputs[1:]):
+        if path not in loaded:
+            loaded[path] = digit_atlas.Font(os.path.join(resources_dir, path))
+        with open(output, 'wb') as f:
+            f.write(atlas_resource(loaded[path], size, chars))
+
+    os.makedirs(os.path.dirname(header_path), exist_ok=True)
+    with open(header_path, 'w') as f:
+        f.write(atlas_header([e[0] for e in entries]))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4:
+        sys.exit('usage: glyph_atlas.py <package.json> <resources-dir> <header>')
+    generate(sys.argv[1], sys.argv[2], sys.argv[3])
@@ -2,11 +2,12 @@
 #include "modules/radial.h"
 #include "modules/big_digit.h"
 #include "modules/border.h"
+#include "modules/font_manager.h"
+#include "modules/widget.h"
 
 static Window *s_main_window;
 
 static GFont s_small_font;
-static GFont s_medium_font;
 static GFont s_large_font;
 
 static BorderWidget *s_border_widget;
@@ -18,52 +19,45 @@ static TextLayer *s_date_layer;
 static TextLayer *s_day_layer;
 static TextLayer *s_hour_layer;
 
-// widget update handlers
-static void seconds_tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-    // Update border seconds widget
-    if (s_border_widget) {
-        widget_border_set_progress(s_border_widget, (float)(tick_time->tm_min) / MINUTES_PER_HOUR);
-    }
-  
+// tick handlers, each called by the widget scheduler only when its unit changed
+static void radial_seconds_tick(void *radial, struct tm *tick_time, TimeUnits units_changed) {
     static char s_buffer[16];
-    
-    if (s_radial_seconds) {
-        strftime(s_buffer, sizeof(s_buffer), "%M", tick_time);
-        widget_radial_set(s_radial_seconds, s_buffer, (float)(tick_time->tm_min) / MINUTES_PER_HOUR);
-    }
-    if (s_digit_hour_tens) {
-        widget_big_digit_set(s_digit_hour_tens, tick_time->tm_min / 10); // Display tens of seconds
-    }
-    if (s_digit_hour_ones) {
-        widget_big_digit_set(s_digit_hour_ones, tick_time->tm_min % 10); // Display last digit of seconds
-    }
-    
-    // Update date layer
+    strftime(s_buffer, sizeof(s_buffer), "%M", tick_time);
+    widget_radial_set(radial, s_buffer, PROGRESS_FRACTION(tick_time->tm_min, MINUTES_PER_HOUR));
+}
+static void digit_tens_tick(void *big_digit, struct tm *tick_time, TimeUnits units_changed) {
+    widget_big_digit_set(big_digit, tick_time->tm_min / 10); // Display tens of seconds
+}
+static void digit_ones_tick(void *big_digit, struct tm *tick_time, TimeUnits units_changed) {
+    widget_big_digit_set(big_digit, tick_time->tm_min % 10); // Display last digit of seconds
+}
+
+// Update date layer
+static void date_tick(void *text_layer, struct tm *tick_time, TimeUnits units_changed) {
     static char buffer[16];
-    if (s_date_layer) {
-      strftime(buffer, sizeof(buffer), "%y %m %d", tick_time);
-      text_layer_set_text(s_date_layer, buffer);
-    }
+    strftime(buffer, sizeof(buffer), "%y %m %d", tick_time);
+    text_layer_set_text(text_layer, buffer);
+}
 
-    // Update day layer
+// Update day layer
+static void day_tick(void *text_layer, struct tm *tick_time, TimeUnits units_changed) {
     static char day_buffer[16];
-    if (s_day_layer) {
-      strftime(day_buffer, sizeof(day_buffer), "%A", tick_time);
-      text_layer_set_text(s_day_layer, day_buffer);
-    }
+    strftime(day_buffer, sizeof(day_buffer), "%A", tick_time);
+    text_layer_set_text(text_layer, day_buffer);
+}
 
-    // Update hour layer
+// Update hour layer
+static void hour_tick(void *text_layer, struct tm *tick_time, TimeUnits units_changed) {
     static char hour_buffer[16];
-    if (s_hour_layer) {
-      strftime(hour_buffer, sizeof(hour_buffer), "%H", tick_time);
-      text_layer_set_text(s_hour_layer, hour_buffer);
-    }
+    strftime(hour_buffer, sizeof(hour_buffer), "%H", tick_time);
+    text_layer_set_text(text_layer, hour_buffer);
 }
+
 static void battery_handler(BatteryChargeState charge_state) {
     static char buffer[16];
     snprintf(buffer, sizeof(buffer), "%d", charge_state.charge_percent);
 
-    widget_radial_set(s_radial_battery, buffer, (float)(charge_state.charge_percent) / 100.0f);
+    widget_radial_set(s_radial_battery, buffer, PROGRESS_FRACTION(charge_state.charge_percent, 100));
 }
 
 // widget creation
@@ -71,9 +65,11 @@ static void main_window_load(Window *window) {
   Layer *window_layer = window_get_root_layer(window);
   GRect bounds = layer_get_bounds(window_layer);
 
-  s_small_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_RUBIK_18));
-  s_medium_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_RUBIK_24));
-  s_large_fount = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_RUBIK_48));
+  // the text layers need their fonts up front; the widgets load theirs on first draw
+  font_manager_acquire(RESOURCE_ID_FONT_RUBIK_18);
+  font_manager_acquire(RESOURCE_ID_FONT_RUBIK_48);
+  s_small_font = font_manager_get(RESOURCE_ID_FONT_RUBIK_18);
+  s_large_font = font_manager_get(RESOURCE_ID_FONT_RUBIK_48);
 
   s_border_widget = widget_border_create(
     GRect(0, 0, bounds.size.w, bounds.size.h),
@@ -88,9 +84,8 @@ static void main_window_load(Window *window) {
   );
   text_layer_set_background_color(s_day_layer, GColorClear);
   text_layer_set_text_color(s_day_layer, GColorWhite);
-  text_layer_set_font(s_day_layer, s_medium_font);
+  text_layer_set_font(s_day_layer, s_small_font);
   text_layer_set_text_alignment(s_day_layer, GTextAlignmentCenter);
-  text_layer_set_text(s_day_layer, "Wednesday");
   layer_add_child(window_layer, text_layer_get_layer(s_day_layer));
 
   s_date_layer = text_layer_create(
@@ -98,9 +93,8 @@ static void main_window_load(Window *window) {
   );
   text_layer_set_background_color(s_date_layer, GColorClear);
   text_layer_set_text_color(s_date_layer, GColorWhite);
-  text_layer_set_font(s_date_layer, s_medium_font);
+  text_layer_set_font(s_date_layer, s_small_font);
   text_layer_set_text_alignment(s_date_layer, GTextAlignmentCenter);
-  text_layer_set_text(s_date_layer, "44 44 44");
   layer_add_child(window_layer, text_layer_get_layer(s_date_layer));
 
   s_hour_layer = text_layer_create(
@@ -108,9 +102,8 @@ static void main_window_load(Window *window) {
   );
   text_layer_set_background_color(s_hour_layer, GColorClear);
   text_layer_set_text_color(s_hour_layer, GColorWhite);
-  text_layer_set_font(s_hour_layer, s_large_fount);
+  text_layer_set_font(s_hour_layer, s_large_font);
   text_layer_set_text_alignment(s_hour_layer, GTextAlignmentCenter);
-  text_layer_set_text(s_hour_layer, "00");
   layer_add_child(window_layer, text_layer_get_layer(s_hour_layer));
 
   // radial seconds widget
@@ -120,11 +113,11 @@ static void main_window_load(Window *window) {
     GColorWhite,
     3, // line thickness
     true, // clockwise
-    s_small_font,
-    18 * 1.3 // text line_height
+    RESOURCE_ID_FONT_RUBIK_18,
+    18 * 13 / 10 // text line_height
   );
   layer_add_child(window_layer, s_radial_seconds->layer);
-  
+
   // radial battery layer
   s_radial_battery = widget_radial_create(
     GRect(bounds.size.w/2 + 37, 6, 32, 32),
@@ -132,8 +125,8 @@ static void main_window_load(Window *window) {
     GColorWhite,
     3, // line thickness
     false, // anti-clockwise
-    s_small_font,
-    18 * 1.3 // text line_height
+    RESOURCE_ID_FONT_RUBIK_18,
+    18 * 13 / 10 // text line_height
   );
   layer_add_child(window_layer, s_radial_battery->layer);
 
@@ -149,32 +142,30 @@ static void main_window_load(Window *window) {
   );
   layer_add_child(window_layer, s_digit_hour_ones->layer);
 
-  // placeholder
-  seconds_tick_handler(localtime(&(time_t){time(NULL)}), SECOND_UNIT);
+  // the border fills over the hour on its own
+  widget_scheduler_add(s_border_widget, &BORDER_WIDGET_CLASS, 0, NULL);
+  widget_scheduler_add(s_radial_seconds, &RADIAL_WIDGET_CLASS, MINUTE_UNIT, radial_seconds_tick);
+  widget_scheduler_add(s_radial_battery, &RADIAL_WIDGET_CLASS, 0, NULL);
+  widget_scheduler_add(s_digit_hour_tens, &BIG_DIGIT_WIDGET_CLASS, MINUTE_UNIT, digit_tens_tick);
+  widget_scheduler_add(s_digit_hour_ones, &BIG_DIGIT_WIDGET_CLASS, MINUTE_UNIT, digit_ones_tick);
+  widget_scheduler_add(s_day_layer, NULL, DAY_UNIT, day_tick);
+  widget_scheduler_add(s_date_layer, NULL, DAY_UNIT, date_tick);
+  widget_scheduler_add(s_hour_layer, NULL, HOUR_UNIT, hour_tick);
+
+  // initial values
+  widget_scheduler_subscribe();
+  widget_scheduler_refresh();
   battery_handler(battery_state_service_peek());
-  
-  layer_mark_dirty(s_digit_hour_tens->layer);
 }
 
 // widget destruction
 static void main_window_unload(Window *window) {
-  if (s_border_widget) widget_border_destroy(s_border_widget);
+  widget_scheduler_destroy_all();
   if (s_date_layer) text_layer_destroy(s_date_layer);
-  if (s_radial_seconds) widget_radial_destroy(s_radial_seconds);
-  if (s_radial_battery) widget_radial_destroy(s_radial_battery);
-  if (s_digit_hour_tens) widget_big_digit_destroy(s_digit_hour_tens);
-  if (s_digit_hour_ones) widget_big_digit_destroy(s_digit_hour_ones);
-  if (s_small_font) fonts_unload_custom_font(s_small_font);
-  if (s_medium_font) fonts_unload_custom_font(s_medium_font);
-  if (s_large_fount) fonts_unload_custom_font(s_large_fount);
-
-  widget_big_digit_unload_images();
-}
-
-void hour_tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  if (!quiet_time_is_active()) {
-    vibes_double_pulse();
-  }
+  if (s_day_layer) text_layer_destroy(s_day_layer);
+  if (s_hour_layer) text_layer_destroy(s_hour_layer);
+  font_manager_release(RESOURCE_ID_FONT_RUBIK_18);
+  font_manager_release(RESOURCE_ID_FONT_RUBIK_48);
 }
 
 static void init() {
@@ -186,17 +177,16 @@ static void init() {
   });
   window_stack_push(s_main_window, true);
 
-  tick_timer_service_subscribe(MINUTE_UNIT, seconds_tick_handler);
-  // tick_timer_service_subscribe(HOUR_UNIT, hour_tick_handler);
   battery_state_service_subscribe(battery_handler);
 }
- 
+
 static void deinit() {
   window_destroy(s_main_window);
 }
- 
+
 int main(void) {
   init();
   app_event_loop();
   deinit();
-}
\ No newline at end of file
+  return 0;
+}